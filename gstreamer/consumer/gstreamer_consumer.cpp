@@ -19,6 +19,9 @@
 
 #include "../util/gst_util.h"
 #include "../util/gst_assert.h"
+#include "../util/gst_bus_dispatcher.h"
+#include "../util/gst_srt.h"
+#include "../util/gst_thread_policy.h"
 
 #include <common/bit_depth.h>
 #include <common/diagnostics/graph.h>
@@ -69,22 +72,26 @@ struct gstreamer_consumer : public core::frame_consumer
     std::thread                                      frame_thread_;
 
     common::bit_depth depth_;
+    std::string       policy_; // Thread policy name, empty for the channel's
     
     // GStreamer pipeline
     gst_ptr<GstElement>     pipeline_;
     gst_ptr<GstElement>     appsrc_;
+    gst_ptr<GstElement>     srt_sink_;
+    std::shared_ptr<void>   bus_watch_;
     
     // Frame buffer & processing
     std::atomic<bool>       is_running_{false};
     std::atomic<bool>       aborting_{false};
 
   public:
-    gstreamer_consumer(std::string path, std::string args, bool realtime, common::bit_depth depth)
+    gstreamer_consumer(std::string path, std::string args, bool realtime, common::bit_depth depth, std::string policy = {})
         : channel_index_(-1)  // Initialize to a default value
         , realtime_(realtime)
         , path_(std::move(path))
         , args_(std::move(args))
         , depth_(depth)
+        , policy_(std::move(policy))
     {
         // Generate a consistent index based on the path 
         // We'll use a simple hash to avoid CRC dependency issues
@@ -94,7 +101,7 @@ struct gstreamer_consumer : public core::frame_consumer
         }
         channel_index_ = static_cast<int>(hash % 10000);
         
-        state_["file/path"] = u8(path_);
+        state_["file/path"] = srt::redact(path_);
 
         frame_buffer_.set_capacity(realtime_ ? 1 : 64);
 
@@ -103,7 +110,7 @@ struct gstreamer_consumer : public core::frame_consumer
         graph_->set_color("dropped-frame", diagnostics::color(0.3f, 0.6f, 0.3f));
         graph_->set_color("input", diagnostics::color(0.7f, 0.4f, 0.4f));
         
-        CASPAR_LOG(info) << "Created GStreamer consumer for " << path_;
+        CASPAR_LOG(info) << "Created GStreamer consumer for " << srt::redact(path_);
     }
 
     ~gstreamer_consumer()
@@ -115,6 +122,8 @@ struct gstreamer_consumer : public core::frame_consumer
             frame_thread_.join();
         }
         
+        bus_watch_.reset();
+        
         if (pipeline_) {
             gst_element_set_state(pipeline_.get(), GST_STATE_NULL);
         }
@@ -167,21 +176,45 @@ struct gstreamer_consumer : public core::frame_consumer
                 // Log the parsed options
                 CASPAR_LOG(info) << "GStreamer consumer options:";
                 for (const auto& pair : options) {
-                    CASPAR_LOG(info) << "  " << pair.first << " = " << pair.second;
+                    CASPAR_LOG(info) << "  " << pair.first << " = " << (pair.first == "passphrase" ? "***" : pair.second);
+                }
+
+                // Thread priority and affinity, from the arguments, the configuration or the channel
+                std::optional<thread_policy> policy;
+                if (options.count("policy")) {
+                    policy = thread_policies::find(options.at("policy"));
+                } else if (!policy_.empty()) {
+                    policy = thread_policies::find(policy_);
+                } else {
+                    policy = thread_policies::for_channel(channel_index_);
+                }
+                if (policy) {
+                    const auto applied = thread_policies::apply(*policy);
+                    
+                    std::lock_guard<std::mutex> lock(state_mutex_);
+                    state_["policy/name"]    = thread_policies::describe(*policy);
+                    state_["policy/applied"] = applied;
                 }
 
                 // Create GStreamer pipeline with the extracted options
                 create_pipeline(options);
                 
                 if (!pipeline_) {
-                    CASPAR_LOG(error) << "Failed to create GStreamer pipeline for " << path_;
+                    CASPAR_LOG(error) << "Failed to create GStreamer pipeline for " << srt::redact(path_);
                     return;
                 }
                 
+                // Streaming threads follow the policy of the consumer
+                if (policy) {
+                    thread_policies::set(pipeline_.get(), *policy);
+                }
+                
+                bus_watch_ = bus_dispatcher::watch(pipeline_.get(), [this](GstMessage* msg) { handle_message(msg); });
+                
                 // Start the pipeline
                 GstStateChangeReturn ret = gst_element_set_state(pipeline_.get(), GST_STATE_PLAYING);
                 if (ret == GST_STATE_CHANGE_FAILURE) {
-                    CASPAR_LOG(error) << "Failed to start GStreamer pipeline for " << path_;
+                    CASPAR_LOG(error) << "Failed to start GStreamer pipeline for " << srt::redact(path_);
                     return;
                 }
                 
@@ -214,7 +247,7 @@ struct gstreamer_consumer : public core::frame_consumer
         return make_ready_future(is_running_.load());
     }
 
-    std::wstring print() const override { return L"gstreamer[" + u16(path_) + L"]"; }
+    std::wstring print() const override { return L"gstreamer[" + u16(srt::redact(path_)) + L"]"; }
 
     std::wstring name() const override { return L"gstreamer"; }
 
@@ -229,6 +262,61 @@ struct gstreamer_consumer : public core::frame_consumer
     }
     
 private:
+    // Runs on the shared bus thread. Errors reach the channel through the next send().
+    void handle_message(GstMessage* msg)
+    {
+        switch (GST_MESSAGE_TYPE(msg)) {
+            case GST_MESSAGE_ERROR: {
+                GError* err      = nullptr;
+                gchar*  dbg_info = nullptr;
+                gst_message_parse_error(msg, &err, &dbg_info);
+                
+                const std::string message = err ? err->message : "unknown";
+                CASPAR_LOG(error) << print() << L" GStreamer error: " << u16(srt::redact(message)) << L" "
+                                  << u16(srt::redact(dbg_info ? dbg_info : ""));
+                g_error_free(err);
+                g_free(dbg_info);
+                
+                try {
+                    CASPAR_THROW_EXCEPTION(gstreamer_error_t() << gstreamer_error_info(message));
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(exception_mutex_);
+                    exception_ = std::current_exception();
+                }
+                break;
+            }
+            
+            case GST_MESSAGE_WARNING: {
+                GError* warn     = nullptr;
+                gchar*  dbg_info = nullptr;
+                gst_message_parse_warning(msg, &warn, &dbg_info);
+                CASPAR_LOG(warning) << print() << L" GStreamer warning: " << u16(srt::redact(warn ? warn->message : "unknown"));
+                g_error_free(warn);
+                g_free(dbg_info);
+                break;
+            }
+            
+            case GST_MESSAGE_EOS:
+                CASPAR_LOG(info) << print() << L" End of stream";
+                is_running_ = false;
+                break;
+                
+            case GST_MESSAGE_STATE_CHANGED: {
+                if (GST_MESSAGE_SRC(msg) == GST_OBJECT(pipeline_.get())) {
+                    GstState old_state, new_state, pending_state;
+                    gst_message_parse_state_changed(msg, &old_state, &new_state, &pending_state);
+                    
+                    std::lock_guard<std::mutex> lock(state_mutex_);
+                    state_["pipeline/state"] = std::string(gst_element_state_get_name(new_state));
+                }
+                break;
+            }
+            
+            default:
+                break;
+        }
+    }
+    
     // Create a GStreamer pipeline based on options
     void create_pipeline(const std::map<std::string, std::string>& options) 
     {
@@ -407,7 +495,7 @@ private:
                 container_format = "flv";
             } else if (path_.substr(0, 7) == "rtsp://") {
                 container_format = "rtp";
-            } else if (path_.substr(0, 6) == "udp://") {
+            } else if (path_.substr(0, 6) == "udp://" || srt::is_srt(path_)) {
                 container_format = "ts";
             } else if (path_.substr(0, 7) == "http://") {
                 container_format = "hls";
@@ -461,6 +549,14 @@ private:
                 }
                 
                 pipeline_desc += "mpegtsmux ! udpsink host=" + host + " port=" + std::to_string(port) + " ";
+            } else if (srt::is_srt(path_)) {
+                // Options override the URI. Without a caller a listener discards the stream
+                // instead of holding up the channel.
+                const auto uri = srt::with_options(path_,
+                                                   {{"mode", get_option("mode", "")},
+                                                    {"latency", get_option("latency", "")},
+                                                    {"passphrase", get_option("passphrase", "")}});
+                pipeline_desc += "mpegtsmux alignment=7 ! srtsink name=srt_sink uri=\"" + uri + "\" wait-for-connection=false ";
             } else if (path_.substr(0, 7) == "http://") {
                 pipeline_desc += "mpegtsmux ! hlssink location=" + path_.substr(7) + " ";
             } else {
@@ -496,13 +592,16 @@ private:
             }
         }
         
-        CASPAR_LOG(info) << "Creating GStreamer pipeline: " << pipeline_desc;
+        CASPAR_LOG(info) << "Creating GStreamer pipeline: " << srt::redact(pipeline_desc);
         
         // Create the pipeline
         pipeline_ = gstreamer::create_pipeline(pipeline_desc);
         
         // Get elements
         appsrc_ = make_gst_ptr<GstElement>(gst_bin_get_by_name(GST_BIN(pipeline_.get()), "video_src"));
+        if (srt::is_srt(path_)) {
+            srt_sink_ = make_gst_ptr<GstElement>(gst_bin_get_by_name(GST_BIN(pipeline_.get()), "srt_sink"));
+        }
         
         if (appsrc_) {
             // Configure appsrc
@@ -521,6 +620,7 @@ private:
     void process_frames() 
     {
         caspar::timer frame_timer;
+        caspar::timer srt_timer;
         int64_t frame_count = 0;
         
         while (!aborting_) {
@@ -564,6 +664,15 @@ private:
             }
             
             graph_->set_value("frame-time", frame_timer.elapsed() * format_desc_.fps * 0.5);
+            
+            // Transport statistics, once a second
+            if (srt_sink_ && srt_timer.elapsed() > 1.0) {
+                srt_timer.restart();
+                if (auto stats = srt::read(srt_sink_.get())) {
+                    std::lock_guard<std::mutex> lock(state_mutex_);
+                    srt::publish(*stats, state_);
+                }
+            }
             graph_->set_value("input", static_cast<double>(frame_buffer_.size() + 0.001) / frame_buffer_.capacity());
         }
         
@@ -632,7 +741,8 @@ create_preconfigured_consumer(const boost::property_tree::wptree&
     return spl::make_shared<gstreamer_consumer>(u8(ptree.get<std::wstring>(L"path", L"")),
                                              u8(ptree.get<std::wstring>(L"args", L"")),
                                              ptree.get(L"realtime", false),
-                                             depth);
+                                             depth,
+                                             u8(ptree.get<std::wstring>(L"policy", L"")));
 }
 
 }} // namespace caspar::gstreamer
\ No newline at end of file
@@ -21,6 +21,7 @@
 
 #include "consumer/gstreamer_consumer.h"
 #include "producer/gstreamer_producer.h"
+#include "util/gst_config.h"
 
 #include <common/log.h>
 
@@ -85,20 +86,10 @@ void init(const core::module_dependencies& dependencies)
     gst_debug_remove_log_function(gst_debug_log_default);
     gst_debug_add_log_function(gst_debug_log_callback, nullptr, nullptr);
     
-    // Set default debug level (can be overridden by GST_DEBUG env var)
-    int debug_level = 2;  // Default debug level
+    // Module settings, the debug level can be overridden with CASPARCG_GST_DEBUG_LEVEL
+    load_config();
     
-    // Get configuration from environment directly to avoid property_tree issues
-    const wchar_t* gst_debug_level = _wgetenv(L"CASPARCG_GST_DEBUG_LEVEL");
-    if (gst_debug_level) {
-        try {
-            debug_level = std::stoi(gst_debug_level);
-        } catch (...) {
-            // Ignore conversion errors and use default
-        }
-    }
-    
-    gst_debug_set_default_threshold(static_cast<GstDebugLevel>(debug_level));
+    gst_debug_set_default_threshold(static_cast<GstDebugLevel>(config().debug_level));
 
     CASPAR_LOG(info) << L"GStreamer initialized, version: " << GST_VERSION_MAJOR << "." 
                      << GST_VERSION_MINOR << "." << GST_VERSION_MICRO;
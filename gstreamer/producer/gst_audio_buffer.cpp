@@ -0,0 +1,199 @@
+#include "gst_audio_buffer.h"
+
+#include <common/log.h>
+#include <common/scope_exit.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace caspar { namespace gstreamer {
+
+namespace {
+
+// Enough to cover the decoder running ahead of the video queues without dropping audio
+constexpr int buffer_seconds = 4;
+
+constexpr std::int64_t second = static_cast<std::int64_t>(GST_SECOND);
+
+} // namespace
+
+GstAudioBuffer::GstAudioBuffer(const core::video_format_desc& format_desc)
+    : channels_(format_desc.audio_channels)
+    , sample_rate_(format_desc.audio_sample_rate)
+    , capacity_(static_cast<std::int64_t>(format_desc.audio_sample_rate) * buffer_seconds)
+    , tolerance_(format_desc.audio_sample_rate / 1000)
+    , ring_(static_cast<std::size_t>(capacity_ * channels_))
+{
+}
+
+void GstAudioBuffer::push(GstSample* sample)
+{
+    GstBuffer* buffer = gst_sample_get_buffer(sample);
+    GstCaps*   caps   = gst_sample_get_caps(sample);
+    if (!buffer || !caps) {
+        return;
+    }
+
+    GstAudioInfo info;
+    if (!gst_audio_info_from_caps(&info, caps) || info.channels <= 0) {
+        return;
+    }
+
+    GstMapInfo map;
+    if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+        CASPAR_LOG(warning) << "[gstreamer] Failed to map audio buffer";
+        return;
+    }
+    CASPAR_SCOPE_EXIT { gst_buffer_unmap(buffer, &map); };
+
+    auto src     = reinterpret_cast<const std::int32_t*>(map.data);
+    auto samples = static_cast<std::int64_t>(map.size / (sizeof(std::int32_t) * info.channels));
+
+    const auto pts = sample_running_time(sample);
+    if (pts < 0) {
+        // Untimed audio simply continues where the previous sample ended
+        if (pts_ < 0) {
+            pts_ = 0;
+        }
+    } else if (pts_ < 0) {
+        pts_ = pts;
+    } else {
+        // Fill gaps with silence and trim overlaps so buffered audio stays on the timeline
+        const auto diff = to_samples(pts - end_pts());
+        if (diff > tolerance_) {
+            write_silence(diff);
+        } else if (diff < -tolerance_) {
+            const auto skip = std::min(-diff, samples);
+            src += skip * info.channels;
+            samples -= skip;
+        }
+    }
+
+    write(src, info.channels, samples);
+}
+
+array<std::int32_t> GstAudioBuffer::take(std::int64_t pts, int samples)
+{
+    const auto count = static_cast<std::size_t>(samples) * channels_;
+
+    // Reuse a buffer no frame refers to anymore, the pool settles at the number of frames in flight
+    auto it = std::find_if(pool_.begin(), pool_.end(), [](const auto& buf) { return buf.use_count() == 1; });
+    if (it == pool_.end()) {
+        pool_.push_back(std::make_shared<std::vector<std::int32_t>>());
+        it = std::prev(pool_.end());
+    }
+    auto storage = *it;
+    storage->resize(count);
+
+    auto dst    = storage->data();
+    int  filled = 0;
+
+    if (pts_ >= 0 && pts >= 0) {
+        const auto offset = to_samples(pts - pts_);
+        if (offset > tolerance_) {
+            // Audio from before this frame is never played
+            if (offset >= size_) {
+                read_ = 0;
+                size_ = 0;
+                pts_  = pts;
+            } else {
+                drop(offset);
+            }
+        } else if (offset < -tolerance_) {
+            // Audio starts later than the frame, lead in with silence
+            filled = static_cast<int>(std::min<std::int64_t>(-offset, samples));
+            std::memset(dst, 0, static_cast<std::size_t>(filled) * channels_ * sizeof(std::int32_t));
+        }
+    }
+
+    auto remaining = static_cast<std::int64_t>(std::min<std::int64_t>(samples - filled, size_));
+    while (remaining > 0) {
+        const auto chunk = std::min(remaining, capacity_ - read_);
+        std::memcpy(dst + static_cast<std::size_t>(filled) * channels_,
+                    ring_.data() + read_ * channels_,
+                    static_cast<std::size_t>(chunk) * channels_ * sizeof(std::int32_t));
+        filled += static_cast<int>(chunk);
+        remaining -= chunk;
+        drop(chunk);
+    }
+
+    if (filled < samples) {
+        std::memset(dst + static_cast<std::size_t>(filled) * channels_,
+                    0,
+                    static_cast<std::size_t>(samples - filled) * channels_ * sizeof(std::int32_t));
+    }
+
+    return array<std::int32_t>(dst, count, std::move(storage));
+}
+
+void GstAudioBuffer::clear()
+{
+    read_ = 0;
+    size_ = 0;
+    pts_  = -1;
+}
+
+std::int64_t GstAudioBuffer::end_pts() const
+{
+    return pts_ < 0 ? -1 : pts_ + to_ns(size_);
+}
+
+void GstAudioBuffer::write(const std::int32_t* src, int src_channels, std::int64_t samples)
+{
+    if (samples > capacity_) {
+        src += (samples - capacity_) * src_channels;
+        drop(size_);
+        pts_ += to_ns(samples - capacity_);
+        samples = capacity_;
+    }
+    if (size_ + samples > capacity_) {
+        // The decoder ran too far ahead, the oldest audio goes first
+        drop(size_ + samples - capacity_);
+    }
+
+    const int copy_channels = std::min(src_channels, channels_);
+
+    auto pos = (read_ + size_) % capacity_;
+    for (std::int64_t n = 0; n < samples; ++n, src += src_channels) {
+        auto dst = ring_.data() + pos * channels_;
+        std::memcpy(dst, src, copy_channels * sizeof(std::int32_t));
+        std::fill(dst + copy_channels, dst + channels_, 0);
+        pos = pos + 1 == capacity_ ? 0 : pos + 1;
+    }
+    size_ += samples;
+}
+
+void GstAudioBuffer::write_silence(std::int64_t samples)
+{
+    samples = std::min(samples, capacity_);
+    if (size_ + samples > capacity_) {
+        drop(size_ + samples - capacity_);
+    }
+
+    auto pos = (read_ + size_) % capacity_;
+    for (std::int64_t n = 0; n < samples; ++n) {
+        std::fill_n(ring_.data() + pos * channels_, channels_, 0);
+        pos = pos + 1 == capacity_ ? 0 : pos + 1;
+    }
+    size_ += samples;
+}
+
+void GstAudioBuffer::drop(std::int64_t samples)
+{
+    samples = std::min(samples, size_);
+    read_   = (read_ + samples) % capacity_;
+    size_ -= samples;
+    pts_ += to_ns(samples);
+}
+
+std::int64_t GstAudioBuffer::to_samples(std::int64_t ns) const
+{
+    return ns * sample_rate_ / second;
+}
+
+std::int64_t GstAudioBuffer::to_ns(std::int64_t samples) const
+{
+    return samples * second / sample_rate_;
+}
+
+}} // namespace caspar::gstreamer
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../util/gst_util.h"
+
+#include <common/array.h>
+
+#include <core/video_format.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace caspar { namespace gstreamer {
+
+// Collects decoded S32 audio in a preallocated ring and slices it into per-frame chunks.
+//
+// Samples are stored in the channel layout of the output format and tracked by running time,
+// so each video frame gets the audio that plays with it, also across segment loops. Missing
+// audio is filled with silence and audio from before the frame is dropped. Only used from the
+// producer thread.
+class GstAudioBuffer
+{
+  public:
+    explicit GstAudioBuffer(const core::video_format_desc& format_desc);
+
+    // Appends an interleaved S32 sample, remapping its channels to the output layout
+    void push(GstSample* sample);
+
+    // Returns exactly 'samples' samples per channel starting at running time 'pts' (ns). The
+    // returned array borrows a pooled buffer which is recycled once every frame holding it is
+    // released.
+    array<std::int32_t> take(std::int64_t pts, int samples);
+
+    void clear();
+
+    // Running time just past the last buffered sample, or -1 when empty
+    std::int64_t end_pts() const;
+
+  private:
+    void write(const std::int32_t* src, int src_channels, std::int64_t samples);
+    void write_silence(std::int64_t samples);
+    void drop(std::int64_t samples);
+
+    std::int64_t to_samples(std::int64_t ns) const;
+    std::int64_t to_ns(std::int64_t samples) const;
+
+    const int          channels_;
+    const int          sample_rate_;
+    const std::int64_t capacity_; // Samples per channel
+    const std::int64_t tolerance_; // Timestamp jitter that is absorbed instead of realigned
+
+    std::vector<std::int32_t> ring_;
+    std::int64_t              read_  = 0;
+    std::int64_t              size_  = 0;
+    std::int64_t              pts_   = -1; // Running time of the sample at read_
+
+    std::vector<std::shared_ptr<std::vector<std::int32_t>>> pool_;
+};
+
+}} // namespace caspar::gstreamer
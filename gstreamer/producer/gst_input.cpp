@@ -1,10 +1,13 @@
 #include "gst_input.h"
 
 #include "../util/gst_assert.h"
+#include "../util/gst_bus_dispatcher.h"
+#include "../util/gst_config.h"
+#include "../util/gst_probe_cache.h"
+#include "../util/gst_srt.h"
 #include "../util/gst_util.h"
 
 #include <common/except.h>
-#include <common/os/thread.h>
 #include <common/param.h>
 #include <common/scope_exit.h>
 
@@ -12,109 +15,176 @@
 #include <boost/filesystem.hpp>
 
 #include <gst/app/gstappsink.h>
+#include <gst/base/gstbasetransform.h>
+
+#include <algorithm>
+#include <utility>
 
 namespace caspar { namespace gstreamer {
 
-GstInput::GstInput(const std::string& uri, std::shared_ptr<diagnostics::graph> graph, std::optional<bool> loop)
+GstInput::GstInput(const std::string&                  uri,
+                   std::shared_ptr<diagnostics::graph> graph,
+                   std::optional<bool>                 loop,
+                   std::optional<int64_t>              live,
+                   std::unique_ptr<GstFilterChain>     filter,
+                   std::optional<thread_policy>        policy)
     : uri_(uri)
     , graph_(graph)
-    , loop_(loop)
+    , loop_(loop.value_or(false))
+    , filter_(std::move(filter))
+    , policy_(std::move(policy))
+    , live_latency_(live.value_or(-1))
 {
-    graph_->set_color("seek", diagnostics::color(1.0f, 0.5f, 0.0f));
-    graph_->set_color("input", diagnostics::color(0.7f, 0.4f, 0.4f));
+    init_graph();
 
     video_buffer_.set_capacity(64);
     audio_buffer_.set_capacity(128);
 
+    // Known clips start out with duration, caps and keyframes from their last load
+    load_probe_cache();
+    
     // Initialize pipeline
     initialize_pipeline(uri_);
     
-    // Start monitor thread
-    thread_ = boost::thread([=] {
-        try {
-            set_thread_name(L"[gstreamer::GstInput]");
+    // Messages are handled on the shared bus thread as soon as they are posted. A pipeline that
+    // failed to build leaves the input invalid and has no bus to watch.
+    if (pipeline_) {
+        bus_watch_ = bus_dispatcher::watch(pipeline_.get(), [this](GstMessage* msg) { handle_message(msg); });
+    }
+}
+
+void GstInput::handle_message(GstMessage* msg)
+{
+    switch (GST_MESSAGE_TYPE(msg)) {
+        case GST_MESSAGE_SEGMENT_DONE:
+            if (loop_) {
+                // Queue the next iteration behind what is still in flight. Without a
+                // flush nothing drains and running time carries on across the loop point.
+                seek(start_, false);
+            } else {
+                eof_ = true;
+                wake();
+            }
+            break;
             
-            // Setup bus monitoring
-            gst_ptr<GstBus> bus(gst_element_get_bus(pipeline_.get()));
-            while (!abort_request_) {
-                gst_ptr<GstMessage> msg(gst_bus_timed_pop(bus.get(), 100 * GST_MSECOND));
-                
-                if (!msg) {
-                    // Timeout - no message
-                    continue;
+        case GST_MESSAGE_EOS:
+            // Also reached when looping was enabled after the last seek, the producer
+            // restarts with a flushing segment seek
+            eof_ = true;
+            wake();
+            break;
+            
+        case GST_MESSAGE_ASYNC_DONE: {
+            if (GST_MESSAGE_SRC(msg) != GST_OBJECT(pipeline_.get())) {
+                break;
+            }
+            
+            // First preroll, duration is known and seeks requested before it can run
+            int64_t pending = -1;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!prerolled_) {
+                    prerolled_ = true;
+                    pending    = std::exchange(pending_seek_, -1);
                 }
+            }
+            update_duration();
+            update_latency();
+            
+            // Every sink prerolled, so audio caps are negotiated before the first sample arrives
+            if (auto caps = make_gst_ptr<GstCaps>(get_audio_caps())) {
+                update_audio_format(caps.get());
+            }
+            
+            if (pending >= 0) {
+                seek(pending, true);
+            }
+            break;
+        }
+        
+        case GST_MESSAGE_ERROR: {
+            error_ = true;
+            
+            GError* err = nullptr;
+            gchar* dbg_info = nullptr;
+            
+            gst_message_parse_error(msg, &err, &dbg_info);
+            CASPAR_LOG(error) << "GStreamer error: " << srt::redact(err ? err->message : "unknown") 
+                             << " " << srt::redact(dbg_info ? dbg_info : "");
+            
+            g_error_free(err);
+            g_free(dbg_info);
+            break;
+        }
+        
+        case GST_MESSAGE_WARNING: {
+            GError* warn = nullptr;
+            gchar* dbg_info = nullptr;
+            
+            gst_message_parse_warning(msg, &warn, &dbg_info);
+            CASPAR_LOG(warning) << "GStreamer warning: " << srt::redact(warn ? warn->message : "unknown") 
+                               << " " << srt::redact(dbg_info ? dbg_info : "");
+            
+            g_error_free(warn);
+            g_free(dbg_info);
+            break;
+        }
+        
+        case GST_MESSAGE_STREAM_START: {
+            // The entry queued on about-to-finish has reached the sinks
+            std::lock_guard<std::mutex> lock(playlist_mutex_);
+            playlist_index_ = playlist_queued_;
+            break;
+        }
+        
+        case GST_MESSAGE_DURATION_CHANGED:
+            update_duration();
+            break;
+            
+        case GST_MESSAGE_LATENCY:
+            // An element changed its latency, redistribute it before reading it back
+            gst_bin_recalculate_latency(GST_BIN(pipeline_.get()));
+            update_latency();
+            break;
+            
+        case GST_MESSAGE_STATE_CHANGED: {
+            // Only interested in pipeline state changes
+            if (GST_MESSAGE_SRC(msg) == GST_OBJECT(pipeline_.get())) {
+                GstState old_state, new_state, pending_state;
+                gst_message_parse_state_changed(msg, &old_state, &new_state, &pending_state);
                 
-                switch (GST_MESSAGE_TYPE(msg.get())) {
-                    case GST_MESSAGE_EOS:
-                        if (loop_.value_or(false)) {
-                            // If looping, seek back to the start
-                            seek(0, true);
-                        } else {
-                            eof_ = true;
-                        }
-                        break;
-                        
-                    case GST_MESSAGE_ERROR: {
-                        GError* err = nullptr;
-                        gchar* dbg_info = nullptr;
-                        
-                        gst_message_parse_error(msg.get(), &err, &dbg_info);
-                        CASPAR_LOG(error) << "GStreamer error: " << (err ? err->message : "unknown") 
-                                         << " " << (dbg_info ? dbg_info : "");
-                        
-                        g_error_free(err);
-                        g_free(dbg_info);
-                        break;
-                    }
-                    
-                    case GST_MESSAGE_WARNING: {
-                        GError* warn = nullptr;
-                        gchar* dbg_info = nullptr;
-                        
-                        gst_message_parse_warning(msg.get(), &warn, &dbg_info);
-                        CASPAR_LOG(warning) << "GStreamer warning: " << (warn ? warn->message : "unknown") 
-                                           << " " << (dbg_info ? dbg_info : "");
-                        
-                        g_error_free(warn);
-                        g_free(dbg_info);
-                        break;
-                    }
-                    
-                    case GST_MESSAGE_STATE_CHANGED: {
-                        // Only interested in pipeline state changes
-                        if (GST_MESSAGE_SRC(msg.get()) == GST_OBJECT(pipeline_.get())) {
-                            GstState old_state, new_state, pending_state;
-                            gst_message_parse_state_changed(msg.get(), &old_state, &new_state, &pending_state);
-                            
-                            if (new_state == GST_STATE_PLAYING) {
-                                // Get stream information when we reach PLAYING state
-                                // Get stream duration
-                                gint64 duration = 0;
-                                if (gst_element_query_duration(pipeline_.get(), GST_FORMAT_TIME, &duration)) {
-                                    // Store duration in milliseconds instead of nanoseconds
-                                    duration_ = duration / GST_MSECOND;
-                                }
-                            }
-                        }
-                        break;
-                    }
-                    
-                    default:
-                        break;
+                if (new_state == GST_STATE_PLAYING) {
+                    // Get stream information when we reach PLAYING state
+                    update_duration();
                 }
             }
-        } catch (...) {
-            CASPAR_LOG_CURRENT_EXCEPTION();
+            break;
         }
-    });
+        
+        default:
+            break;
+    }
 }
 
 GstInput::~GstInput()
 {
-    abort_request_ = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        abort_request_ = true;
+    }
+    cond_.notify_all();
+    
+    // No handler runs once the watch is gone
+    bus_watch_.reset();
     
-    if (thread_.joinable()) {
-        thread_.join();
+    // Remember what this load learned while the negotiated caps are still around. The index of
+    // a playlist mixes several clips.
+    try {
+        if (playlist().empty()) {
+            store_probe_cache();
+        }
+    } catch (...) {
+        CASPAR_LOG_CURRENT_EXCEPTION();
     }
     
     if (pipeline_) {
@@ -122,28 +192,58 @@ GstInput::~GstInput()
     }
     
     // Free any remaining samples in the queues
-    GstSample* sample = nullptr;
-    while (video_buffer_.try_pop(sample)) {
-        if (sample) {
-            gst_sample_unref(sample);
-        }
+    clear(video_buffer_);
+    clear(audio_buffer_);
+}
+
+void GstInput::update_duration()
+{
+    gint64 duration = 0;
+    if (gst_element_query_duration(pipeline_.get(), GST_FORMAT_TIME, &duration)) {
+        // Store duration in milliseconds instead of nanoseconds
+        duration_ = duration / GST_MSECOND;
     }
+}
+
+void GstInput::update_latency()
+{
+    GstQuery* query = gst_query_new_latency();
+    CASPAR_SCOPE_EXIT { gst_query_unref(query); };
     
-    while (audio_buffer_.try_pop(sample)) {
-        if (sample) {
-            gst_sample_unref(sample);
-        }
+    if (gst_element_query(pipeline_.get(), query)) {
+        gboolean     live = FALSE;
+        GstClockTime min  = 0;
+        GstClockTime max  = 0;
+        gst_query_parse_latency(query, &live, &min, &max);
+        latency_ = live && GST_CLOCK_TIME_IS_VALID(min) ? static_cast<int64_t>(min) : 0;
     }
 }
 
+void GstInput::init_graph()
+{
+    auto graph = this->graph();
+    graph->set_color("seek", diagnostics::color(1.0f, 0.5f, 0.0f));
+    graph->set_color("input", diagnostics::color(0.7f, 0.4f, 0.4f));
+}
+
+std::shared_ptr<diagnostics::graph> GstInput::graph() const
+{
+    return std::atomic_load(&graph_);
+}
+
+void GstInput::graph(std::shared_ptr<diagnostics::graph> graph)
+{
+    std::atomic_store(&graph_, std::move(graph));
+    init_graph();
+}
+
 void GstInput::initialize_pipeline(const std::string& uri)
 {
     try {
-        // Fix: Create the pipeline and assign the result to pipeline_ member variable
-        pipeline_ = gstreamer::create_pipeline(uri);
+        create_pipeline(uri);
         
         if (!pipeline_) {
-            CASPAR_LOG(error) << "Failed to create GStreamer pipeline for URI: " << uri;
+            CASPAR_LOG(error) << "Failed to create GStreamer pipeline for URI: " << srt::redact(uri);
             return;
         }
         
@@ -156,6 +256,12 @@ void GstInput::initialize_pipeline(const std::string& uri)
             return;
         }
         
+        // Live sources don't preroll, so no ASYNC_DONE will follow
+        if (ret != GST_STATE_CHANGE_ASYNC) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            prerolled_ = true;
+        }
+        
         // Get video information
         if (video_appsink_) {
             GstPad* pad = gst_element_get_static_pad(video_appsink_.get(), "sink");
@@ -173,21 +279,9 @@ void GstInput::initialize_pipeline(const std::string& uri)
             }
         }
         
-        // Get audio information
-        if (audio_appsink_) {
-            GstPad* pad = gst_element_get_static_pad(audio_appsink_.get(), "sink");
-            if (pad) {
-                GstCaps* caps = gst_pad_get_current_caps(pad);
-                if (caps) {
-                    GstAudioInfo info;
-                    if (gst_audio_info_from_caps(&info, caps)) {
-                        audio_channels_ = info.channels;
-                        audio_sample_rate_ = info.rate;
-                    }
-                    gst_caps_unref(caps);
-                }
-                gst_object_unref(pad);
-            }
+        // Get audio information, prerolling sources report it again on ASYNC_DONE
+        if (auto caps = make_gst_ptr<GstCaps>(get_audio_caps())) {
+            update_audio_format(caps.get());
         }
         
         initialized_ = true;
@@ -203,25 +297,68 @@ void GstInput::initialize_pipeline(const std::string& uri)
 // Explicitly defining the signature for the wrapper function to match GStreamer's expectation
 GstFlowReturn GstInput::new_video_sample(GstAppSink* sink, gpointer user_data)
 {
-    GstInput* self = static_cast<GstInput*>(user_data);
-    
     GstSample* sample = gst_app_sink_pull_sample(sink);
     if (!sample) {
         return GST_FLOW_ERROR;
     }
     
-    // Add ref for the sample so it stays alive in the queue
-    gst_sample_ref(sample);
+    static_cast<GstInput*>(user_data)->push_video(sample, false);
+    return GST_FLOW_OK;
+}
+
+GstFlowReturn GstInput::new_video_preroll(GstAppSink* sink, gpointer user_data)
+{
+    GstSample* sample = gst_app_sink_pull_preroll(sink);
+    if (!sample) {
+        return GST_FLOW_ERROR;
+    }
     
-    if (!self->video_buffer_.try_push(sample)) {
-        // Queue is full, free the sample we just created
-        gst_sample_unref(sample);
-        return GST_FLOW_OK;
+    static_cast<GstInput*>(user_data)->push_video(sample, true);
+    return GST_FLOW_OK;
+}
+
+void GstInput::push_video(GstSample* sample, bool preroll)
+{
+    // The pulled reference is handed over to the queue
+    GstCaps* caps = gst_sample_get_caps(sample);
+    if (caps && (!video_caps_ || !gst_caps_is_equal(caps, video_caps_.get()))) {
+        video_caps_ = make_gst_ptr<GstCaps>(gst_caps_ref(caps));
+        update_video_format(caps);
     }
     
-    self->graph_->set_value("input", static_cast<double>(self->video_buffer_.size()) / self->video_buffer_.capacity());
+    GstBuffer* buffer = gst_sample_get_buffer(sample);
     
-    return GST_FLOW_OK;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        
+        // A prerolled buffer is rendered again once the pipeline goes to PLAYING. It was queued
+        // as soon as it prerolled, which is what makes the first frame available in PAUSED.
+        const bool duplicate =
+            !preroll && preroll_pending_ && buffer && GST_BUFFER_PTS(buffer) == preroll_pts_;
+        preroll_pending_ = preroll;
+        preroll_pts_     = preroll && buffer ? GST_BUFFER_PTS(buffer) : GST_CLOCK_TIME_NONE;
+        
+        // Local sources are decoded ahead only as far as the queue allows, live network
+        // sources can't be paused and drop instead.
+        if (!network_ && !duplicate) {
+            cond_.wait(lock, [&] {
+                return video_buffer_.size() < video_depth_ || video_flushing_ || abort_request_;
+            });
+        }
+        
+        if (duplicate || video_flushing_ || abort_request_ || !video_buffer_.try_push(sample)) {
+            // Queue is full or being flushed, free the sample we just pulled
+            lock.unlock();
+            gst_sample_unref(sample);
+            return;
+        }
+        video_pushed_++;
+    }
+    
+    // Wake the producer as soon as a frame is decoded
+    cond_.notify_all();
+    
+    graph()->set_value("input", static_cast<double>(video_buffer_.size()) / video_depth_);
 }
 
 GstFlowReturn GstInput::new_audio_sample(GstAppSink* sink, gpointer user_data)
@@ -233,25 +370,107 @@ GstFlowReturn GstInput::new_audio_sample(GstAppSink* sink, gpointer user_data)
         return GST_FLOW_ERROR;
     }
     
-    // Add ref for the sample so it stays alive in the queue
-    gst_sample_ref(sample);
+    // Live sources don't preroll and playlist entries may change the format
+    GstCaps* caps = gst_sample_get_caps(sample);
+    if (caps && (!self->audio_caps_ || !gst_caps_is_equal(caps, self->audio_caps_.get()))) {
+        self->audio_caps_ = make_gst_ptr<GstCaps>(gst_caps_ref(caps));
+        self->update_audio_format(caps);
+    }
     
-    if (!self->audio_buffer_.try_push(sample)) {
-        // Queue is full, free the sample we just created
-        gst_sample_unref(sample);
-        return GST_FLOW_OK;
+    // The pulled reference is handed over to the queue
+    {
+        std::unique_lock<std::mutex> lock(self->mutex_);
+        
+        // Same as video, local sources wait for the producer instead of losing audio
+        if (!self->network_) {
+            self->cond_.wait(lock, [&] {
+                return self->audio_buffer_.size() < self->audio_depth_ || self->audio_flushing_ ||
+                       self->abort_request_;
+            });
+        }
+        
+        if (self->audio_flushing_ || self->abort_request_ || !self->audio_buffer_.try_push(sample)) {
+            // Queue is full or being flushed, free the sample we just pulled
+            lock.unlock();
+            gst_sample_unref(sample);
+            return GST_FLOW_OK;
+        }
     }
     
+    self->cond_.notify_all();
+    
     return GST_FLOW_OK;
 }
 
+GstPadProbeReturn GstInput::sink_event_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    GstInput* self  = static_cast<GstInput*>(user_data);
+    GstEvent* event = GST_PAD_PROBE_INFO_EVENT(info);
+    
+    const bool video    = GST_PAD_PARENT(pad) == self->video_appsink_.get();
+    auto&      flushing = video ? self->video_flushing_ : self->audio_flushing_;
+    
+    switch (GST_EVENT_TYPE(event)) {
+        case GST_EVENT_FLUSH_START: {
+            // Release a streaming thread blocked on a full queue so the flush can proceed
+            {
+                std::lock_guard<std::mutex> lock(self->mutex_);
+                flushing = true;
+            }
+            self->cond_.notify_all();
+            break;
+        }
+        
+        case GST_EVENT_FLUSH_STOP: {
+            // Everything queued so far predates the flush, everything after it belongs to the new segment
+            {
+                std::lock_guard<std::mutex> lock(self->mutex_);
+                clear(video ? self->video_buffer_ : self->audio_buffer_);
+                flushing = false;
+                
+                // Samples of entries that were still queued are gone, what follows is the latest one
+                if (video) {
+                    if (!self->entry_starts_.empty()) {
+                        self->video_entry_ = self->entry_starts_.back().second;
+                        self->entry_starts_.clear();
+                    }
+                    self->video_popped_ = self->video_pushed_;
+                }
+            }
+            self->cond_.notify_all();
+            break;
+        }
+        
+        case GST_EVENT_STREAM_START: {
+            // Every sample of the previous entry is queued by now, the next ones belong to the
+            // entry queued on about-to-finish. It is on air once the first of them is popped.
+            if (video) {
+                int entry = 0;
+                {
+                    std::lock_guard<std::mutex> lock(self->playlist_mutex_);
+                    entry = self->playlist_queued_;
+                }
+                std::lock_guard<std::mutex> lock(self->mutex_);
+                self->entry_starts_.emplace_back(self->video_pushed_, entry);
+            }
+            break;
+        }
+        
+        default:
+            break;
+    }
+    
+    return GST_PAD_PROBE_OK;
+}
+
 void GstInput::create_pipeline(const std::string& uri)
 {
     if (uri.empty()) {
         CASPAR_THROW_EXCEPTION(caspar_exception() << msg_info_t("URI cannot be empty"));
     }
     
-    // Create a basic playbin pipeline that will handle most formats
+    // Create a basic playbin pipeline that will handle most formats. Network sources such as
+    // rtmp:// are resolved through playbin's URI handlers as well.
     std::string pipeline_desc = "playbin uri=\"" + uri + "\" ";
     
     // Check if we need to use specific protocols
@@ -264,94 +483,559 @@ void GstInput::create_pipeline(const std::string& uri)
         path = uri.substr(protocol_separator + 3);
     }
     
-    if (protocol == "rtmp" || protocol == "rtmps") {
-        // Use rtmpsrc for RTMP streams
-        pipeline_desc = "rtmpsrc location=\"" + uri + "\" ! decodebin name=decode ";
-    } else if (protocol == "http" || protocol == "https") {
-        // For HTTP streams, configure appropriate settings
-        pipeline_desc = "playbin uri=\"" + uri + "\" buffer-duration=2000000000 ";
+    network_ = !protocol.empty() && protocol != "file";
+    live_    = network_ && live_latency_ >= 0;
+    
+    if (protocol == "http" || protocol == "https") {
+        // For HTTP streams, configure appropriate settings. Live mode only buffers up to the
+        // target latency instead of two seconds.
+        const auto buffer_duration = live_ ? live_latency_ * static_cast<int64_t>(GST_MSECOND) : int64_t{2000000000};
+        pipeline_desc = "playbin uri=\"" + uri + "\" buffer-duration=" + std::to_string(buffer_duration) + " ";
     } else if (boost::filesystem::exists(uri)) {
         // Local file - use playbin with filesrc
-        pipeline_desc = "playbin uri=\"file://" + uri + "\" ";
+        pipeline_desc = "playbin uri=\"" + to_uri(uri) + "\" ";
     }
     
-    // Create separate video and audio sinks for the pipeline
-    pipeline_desc += " video-sink=\"appsink name=video_sink max-buffers=64 drop=true sync=true\" ";
-    pipeline_desc += " audio-sink=\"appsink name=audio_sink max-buffers=128 drop=false sync=true\" ";
-    
-    // Create the pipeline - Fix: Use global function with explicit namespace
     pipeline_ = gstreamer::create_pipeline(pipeline_desc);
+    if (policy_) {
+        thread_policies::set(pipeline_.get(), *policy_);
+    }
     
-    // Get the video appsink
-    video_appsink_ = make_gst_ptr<GstElement>(gst_bin_get_by_name(GST_BIN(pipeline_.get()), "video_sink"));
-    if (video_appsink_) {
-        // Set up video sink
-        gst_app_sink_set_emit_signals(GST_APP_SINK(video_appsink_.get()), FALSE);
-        gst_app_sink_set_drop(GST_APP_SINK(video_appsink_.get()), TRUE);
-        gst_app_sink_set_max_buffers(GST_APP_SINK(video_appsink_.get()), 64);
-        
-        // Set up video caps
-        GstCaps* video_caps = gst_caps_new_simple("video/x-raw",
-                                                 "format", G_TYPE_STRING, "BGRA",
-                                                 NULL);
-        gst_app_sink_set_caps(GST_APP_SINK(video_appsink_.get()), video_caps);
-        gst_caps_unref(video_caps);
-        
-        // Setup callbacks for new samples
-        GstAppSinkCallbacks video_callbacks;
-        memset(&video_callbacks, 0, sizeof(GstAppSinkCallbacks));
-        
-        // Set the direct callback using the static method from our class
-        video_callbacks.new_sample = &GstInput::new_video_sample;
-        
-        gst_app_sink_set_callbacks(GST_APP_SINK(video_appsink_.get()), &video_callbacks, this, nullptr);
+    // Queues the next playlist entry while the current one is still playing
+    g_signal_connect(pipeline_.get(), "about-to-finish", G_CALLBACK(&GstInput::about_to_finish), this);
+    
+    // Every element playbin creates passes through here, which is where the video decoder is found
+    g_signal_connect(pipeline_.get(), "element-setup", G_CALLBACK(&GstInput::element_setup), this);
+    
+    // Decoded video should reach the appsink in its native format, so playsink's own converters
+    // are disabled and a single videoconvert in our sink bin handles anything the mixer can't take.
+    gst_util_set_object_arg(G_OBJECT(pipeline_.get()), "flags", "video+audio+native-video");
+    
+    video_convert_ = make_element("videoconvert", "video_convert");
+    video_appsink_ = make_element("appsink", "video_sink");
+    audio_appsink_ = make_element("appsink", "audio_sink");
+    
+    // Set up video sink. Network sources are rendered against the clock and drop when the
+    // producer falls behind, local sources are decoded as fast as the producer consumes them.
+    // In live mode samples are handed over as soon as they are decoded and the producer paces
+    // them by the channel tick, so a drifting sender clock can't build up latency in the sinks.
+    gst_app_sink_set_emit_signals(GST_APP_SINK(video_appsink_.get()), FALSE);
+    gst_app_sink_set_drop(GST_APP_SINK(video_appsink_.get()), network_);
+    gst_app_sink_set_max_buffers(GST_APP_SINK(video_appsink_.get()), 64);
+    g_object_set(G_OBJECT(video_appsink_.get()), "sync", network_ && !live_, NULL);
+    
+    // Set up video caps. Every format listed here is uploaded as is and converted on the mixer GPU,
+    // which keeps videoconvert in passthrough for the common decoder outputs.
+    GstCaps* video_caps = gst_caps_from_string("video/x-raw, format=(string){ I420, YV12, NV12, NV21, Y42B, Y444, "
+                                               "I420_10LE, I422_10LE, P010_10LE, v210, A420, UYVY, BGRA, RGBA, "
+                                               "ARGB, ABGR, GRAY8 }");
+    gst_app_sink_set_caps(GST_APP_SINK(video_appsink_.get()), video_caps);
+    gst_caps_unref(video_caps);
+    
+    // Setup callbacks for new samples
+    GstAppSinkCallbacks video_callbacks;
+    memset(&video_callbacks, 0, sizeof(GstAppSinkCallbacks));
+    
+    // Set the direct callback using the static method from our class
+    video_callbacks.new_sample  = &GstInput::new_video_sample;
+    video_callbacks.new_preroll = &GstInput::new_video_preroll;
+    
+    gst_app_sink_set_callbacks(GST_APP_SINK(video_appsink_.get()), &video_callbacks, this, nullptr);
+    
+    // Filters, cropping and scaling run on the decoded format, before anything is converted
+    std::vector<GstElement*> video_elements;
+    if (filter_) {
+        video_elements = filter_->elements();
     }
+    video_elements.push_back(video_convert_.get());
+    video_elements.push_back(video_appsink_.get());
     
-    // Get the audio appsink
-    audio_appsink_ = make_gst_ptr<GstElement>(gst_bin_get_by_name(GST_BIN(pipeline_.get()), "audio_sink"));
-    if (audio_appsink_) {
-        // Set up audio sink
-        gst_app_sink_set_emit_signals(GST_APP_SINK(audio_appsink_.get()), FALSE);
-        gst_app_sink_set_drop(GST_APP_SINK(audio_appsink_.get()), FALSE);
-        gst_app_sink_set_max_buffers(GST_APP_SINK(audio_appsink_.get()), 128);
-        
-        // Set up audio caps
-        GstCaps* audio_caps = gst_caps_new_simple("audio/x-raw",
-                                                 "format", G_TYPE_STRING, "S32LE",
-                                                 "rate", G_TYPE_INT, 48000,
-                                                 "channels", G_TYPE_INT, 2,
-                                                 "layout", G_TYPE_STRING, "interleaved",
-                                                 NULL);
-        gst_app_sink_set_caps(GST_APP_SINK(audio_appsink_.get()), audio_caps);
-        gst_caps_unref(audio_caps);
-        
-        // Setup callbacks for new samples
-        GstAppSinkCallbacks audio_callbacks;
-        memset(&audio_callbacks, 0, sizeof(GstAppSinkCallbacks));
+    g_object_set(G_OBJECT(pipeline_.get()), "video-sink", make_sink_bin("video_sink_bin", video_elements), NULL);
+    
+    // Set up audio sink
+    gst_app_sink_set_emit_signals(GST_APP_SINK(audio_appsink_.get()), FALSE);
+    gst_app_sink_set_drop(GST_APP_SINK(audio_appsink_.get()), FALSE);
+    gst_app_sink_set_max_buffers(GST_APP_SINK(audio_appsink_.get()), 128);
+    g_object_set(G_OBJECT(audio_appsink_.get()), "sync", network_ && !live_, NULL);
+    
+    // Set up audio caps
+    GstCaps* audio_caps = gst_caps_new_simple("audio/x-raw",
+                                             "format", G_TYPE_STRING, "S32LE",
+                                             "rate", G_TYPE_INT, 48000,
+                                             "channels", G_TYPE_INT, 2,
+                                             "layout", G_TYPE_STRING, "interleaved",
+                                             NULL);
+    gst_app_sink_set_caps(GST_APP_SINK(audio_appsink_.get()), audio_caps);
+    gst_caps_unref(audio_caps);
+    
+    // Setup callbacks for new samples
+    GstAppSinkCallbacks audio_callbacks;
+    memset(&audio_callbacks, 0, sizeof(GstAppSinkCallbacks));
+    
+    // Set the direct callback using the static method from our class
+    audio_callbacks.new_sample = &GstInput::new_audio_sample;
+    
+    gst_app_sink_set_callbacks(GST_APP_SINK(audio_appsink_.get()), &audio_callbacks, this, nullptr);
+    
+    g_object_set(G_OBJECT(pipeline_.get()), "audio-sink", audio_appsink_.get(), NULL);
+    
+    // Keeps the pitch of audio played at a different rate, passthrough at normal speed. Live
+    // sources always play at normal speed.
+    if (!live_) {
+        GError*     error  = nullptr;
+        GstElement* filter = gst_parse_bin_from_description("audioconvert ! scaletempo ! audioconvert", TRUE, &error);
+        if (filter) {
+            g_object_set(G_OBJECT(pipeline_.get()), "audio-filter", filter, NULL);
+        } else {
+            CASPAR_LOG(warning) << "[gstreamer] scaletempo unavailable, audio is distorted at other rates: "
+                                << (error ? error->message : "unknown");
+        }
+        if (error) {
+            g_error_free(error);
+        }
+    }
+    
+    // Flushes are tracked on the sink pads so queued samples from before a seek are dropped exactly
+    for (const auto& sink : {video_appsink_, audio_appsink_}) {
+        GstPad* pad = gst_element_get_static_pad(sink.get(), "sink");
+        gst_pad_add_probe(pad,
+                          static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM | GST_PAD_PROBE_TYPE_EVENT_FLUSH),
+                          &GstInput::sink_event_probe,
+                          this,
+                          nullptr);
+        gst_object_unref(pad);
+    }
+}
+
+void GstInput::element_setup(GstElement* pipeline, GstElement* element, gpointer user_data)
+{
+    GstInput* self = static_cast<GstInput*>(user_data);
+    
+    GstElementFactory* factory = gst_element_get_factory(element);
+    const std::string  name    = factory ? GST_OBJECT_NAME(factory) : "";
+    
+    // Jitter buffers of live sources default to seconds, hold them to the target latency. A
+    // latency in the SRT URI is what the link was set up for and stays.
+    const bool srt_latency = name == "srtsrc" && !srt::option(self->uri_, "latency").empty();
+    if (self->live_ && !srt_latency && (name == "rtspsrc" || name == "rtpjitterbuffer" || name == "srtsrc")) {
+        gst_util_set_object_arg(G_OBJECT(element), "latency", std::to_string(self->live_latency_).c_str());
+    }
+    
+    if (name == "srtsrc") {
+        std::lock_guard<std::mutex> lock(self->index_mutex_);
+        self->srt_source_ = make_gst_ptr<GstElement>(GST_ELEMENT(gst_object_ref(element)));
+    }
+    
+    if (!GST_IS_VIDEO_DECODER(element)) {
+        return;
+    }
+    
+    // Everything reaching the decoder is still compressed and carries the keyframe flags, flushes
+    // mark where decoding jumped and stream starts where the next playlist entry begins
+    GstPad* pad = gst_element_get_static_pad(element, "sink");
+    if (pad) {
+        gst_pad_add_probe(pad,
+                          static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_FLUSH |
+                                                       GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM),
+                          &GstInput::decoder_buffer_probe,
+                          self,
+                          nullptr);
+        gst_object_unref(pad);
+    }
+    
+    std::lock_guard<std::mutex> lock(self->index_mutex_);
+    self->video_decoder_ = name;
+}
+
+GstPadProbeReturn GstInput::decoder_buffer_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    GstInput* self = static_cast<GstInput*>(user_data);
+    
+    if (GST_PAD_PROBE_INFO_TYPE(info) & (GST_PAD_PROBE_TYPE_EVENT_FLUSH | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM)) {
+        std::lock_guard<std::mutex> lock(self->index_mutex_);
+        switch (GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info))) {
+            case GST_EVENT_FLUSH_STOP:
+                // Decoding continues somewhere else, a new stretch starts with the next buffer
+                self->run_from_  = -1;
+                self->run_until_ = -1;
+                break;
+                
+            case GST_EVENT_STREAM_START:
+                // The playlist entry queued on about-to-finish gets its own index. The previous
+                // clip's decoder may still be draining, its buffers are ignored from here on.
+                if (std::exchange(self->index_reset_, false)) {
+                    self->keyframes_.clear();
+                    self->indexed_until_ = -1;
+                    self->run_from_      = 0;
+                    self->run_until_     = -1;
+                }
+                self->index_pad_ = pad;
+                break;
+                
+            default:
+                break;
+        }
+        return GST_PAD_PROBE_OK;
+    }
+    
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    const auto pts    = static_cast<int64_t>(GST_BUFFER_PTS(buffer));
+    if (!GST_CLOCK_TIME_IS_VALID(GST_BUFFER_PTS(buffer))) {
+        return GST_PAD_PROBE_OK;
+    }
+    
+    std::lock_guard<std::mutex> lock(self->index_mutex_);
+    if (self->index_pad_ && pad != self->index_pad_) {
+        return GST_PAD_PROBE_OK;
+    }
+    if (!GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+        self->keyframes_.insert(pts);
+    }
+    
+    // Trick modes skip everything between keyframes, that says nothing about the keyframes in between
+    if (self->run_trickmode_) {
+        return GST_PAD_PROBE_OK;
+    }
+    if (self->run_from_ < 0) {
+        self->run_from_ = pts;
+    }
+    self->run_until_ = std::max(self->run_until_, pts);
+    
+    // A stretch that starts within the index from the start of the stream extends it
+    if (self->run_from_ <= std::max<int64_t>(self->indexed_until_, 0)) {
+        self->indexed_until_ = std::max(self->indexed_until_, self->run_until_);
+    }
+    
+    return GST_PAD_PROBE_OK;
+}
+
+void GstInput::load_probe_cache()
+{
+    probe_stamp_ = probe_cache::stamp(uri_);
+    if (!probe_stamp_) {
+        return;
+    }
+    
+    auto info = probe_cache::find(uri_, *probe_stamp_);
+    if (!info) {
+        return;
+    }
+    
+    duration_ = info->duration;
+    
+    if (!info->video_caps.empty()) {
+        auto caps = make_gst_ptr<GstCaps>(gst_caps_from_string(info->video_caps.c_str()));
+        GstVideoInfo video_info;
+        if (caps && gst_video_info_from_caps(&video_info, caps.get())) {
+            width_        = video_info.width;
+            height_       = video_info.height;
+            video_format_ = GST_VIDEO_INFO_FORMAT(&video_info);
+        }
+    }
+    
+    if (!info->audio_caps.empty()) {
+        auto caps = make_gst_ptr<GstCaps>(gst_caps_from_string(info->audio_caps.c_str()));
+        GstAudioInfo audio_info;
+        if (caps && gst_audio_info_from_caps(&audio_info, caps.get())) {
+            audio_channels_    = audio_info.channels;
+            audio_sample_rate_ = audio_info.rate;
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(index_mutex_);
+        keyframes_.insert(info->keyframes.begin(), info->keyframes.end());
+        indexed_until_ = info->indexed_until;
+        video_decoder_ = info->video_decoder;
+    }
+    
+    cached_          = true;
+    cached_until_    = info->indexed_until;
+    cached_duration_ = info->duration;
+}
+
+void GstInput::store_probe_cache()
+{
+    if (!probe_stamp_) {
+        return;
+    }
+    
+    media_info info;
+    info.duration = duration_;
+    
+    {
+        std::lock_guard<std::mutex> lock(index_mutex_);
+        // Keyframes seen past the gapless stretch from the start may have others between them
+        info.indexed_until = indexed_until_;
+        info.keyframes.assign(keyframes_.begin(), keyframes_.upper_bound(indexed_until_));
+        info.video_decoder = video_decoder_;
+    }
+    
+    // Nothing new since the entry was loaded, or nothing learned at all
+    if (info.indexed_until <= cached_until_ && info.duration == cached_duration_) {
+        return;
+    }
+    
+    auto video_caps = make_gst_ptr<GstCaps>(get_video_caps());
+    auto audio_caps = make_gst_ptr<GstCaps>(get_audio_caps());
+    if (video_caps) {
+        info.video_caps = caps_to_string(video_caps.get());
+    }
+    if (audio_caps) {
+        info.audio_caps = caps_to_string(audio_caps.get());
+    }
+    
+    probe_cache::store(uri_, *probe_stamp_, info);
+}
+
+std::string GstInput::to_uri(const std::string& location)
+{
+    return boost::filesystem::exists(location) ? "file://" + location : location;
+}
+
+void GstInput::about_to_finish(GstElement* pipeline, gpointer user_data)
+{
+    GstInput* self = static_cast<GstInput*>(user_data);
+    
+    std::string uri;
+    {
+        std::lock_guard<std::mutex> lock(self->playlist_mutex_);
+        if (self->playlist_.empty()) {
+            return;
+        }
         
-        // Set the direct callback using the static method from our class
-        audio_callbacks.new_sample = &GstInput::new_audio_sample;
+        auto next = self->playlist_queued_ + 1;
+        if (next >= static_cast<int>(self->playlist_.size())) {
+            if (!self->loop_) {
+                return;
+            }
+            next = 0;
+        }
         
-        gst_app_sink_set_callbacks(GST_APP_SINK(audio_appsink_.get()), &audio_callbacks, this, nullptr);
+        self->playlist_queued_ = next;
+        uri                    = to_uri(self->playlist_[next]);
+    }
+    
+    // The current clip is still decoding, the index is reset once the next one starts
+    {
+        std::lock_guard<std::mutex> lock(self->index_mutex_);
+        self->index_reset_ = true;
+    }
+    
+    CASPAR_LOG(debug) << "GstInput queueing playlist entry " << srt::redact(uri);
+    g_object_set(G_OBJECT(pipeline), "uri", uri.c_str(), NULL);
+}
+
+void GstInput::playlist(std::vector<std::string> entries)
+{
+    std::lock_guard<std::mutex> lock(playlist_mutex_);
+    playlist_        = std::move(entries);
+    playlist_queued_ = 0;
+    playlist_index_  = 0;
+    video_entry_     = 0;
+}
+
+void GstInput::playlist_append(const std::string& entry)
+{
+    std::lock_guard<std::mutex> lock(playlist_mutex_);
+    if (playlist_.empty()) {
+        // Turning a single clip into a playlist
+        playlist_.push_back(uri_);
+    }
+    playlist_.push_back(entry);
+}
+
+bool GstInput::playlist_remove(std::size_t index)
+{
+    std::lock_guard<std::mutex> lock(playlist_mutex_);
+    
+    // Entries already handed to playbin can't be taken back
+    const auto playing = static_cast<std::size_t>(std::max<int>(playlist_index_, playlist_queued_));
+    if (index >= playlist_.size() || index <= playing) {
+        return false;
+    }
+    
+    playlist_.erase(playlist_.begin() + index);
+    return true;
+}
+
+std::vector<std::string> GstInput::playlist() const
+{
+    std::lock_guard<std::mutex> lock(playlist_mutex_);
+    return playlist_;
+}
+
+int64_t GstInput::keyframe_before(int64_t position) const
+{
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    
+    auto it = keyframes_.upper_bound(position);
+    if (it == keyframes_.begin()) {
+        return -1;
+    }
+    return *std::prev(it);
+}
+
+bool GstInput::indexed(int64_t from, int64_t to) const
+{
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    return (from >= 0 && to <= indexed_until_) || (run_from_ >= 0 && from >= run_from_ && to <= run_until_);
+}
+
+int64_t GstInput::indexed_until() const
+{
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    return indexed_until_;
+}
+
+std::string GstInput::video_decoder() const
+{
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    return video_decoder_;
+}
+
+std::optional<srt::stats> GstInput::srt_stats() const
+{
+    gst_ptr<GstElement> source;
+    {
+        std::lock_guard<std::mutex> lock(index_mutex_);
+        source = srt_source_;
     }
+    return source ? srt::read(source.get()) : std::nullopt;
+}
+
+void GstInput::update_audio_format(GstCaps* caps)
+{
+    GstAudioInfo info;
+    if (gst_audio_info_from_caps(&info, caps)) {
+        audio_channels_    = info.channels;
+        audio_sample_rate_ = info.rate;
+    }
+}
+
+void GstInput::update_video_format(GstCaps* caps)
+{
+    GstVideoInfo info;
+    if (!gst_video_info_from_caps(&info, caps)) {
+        return;
+    }
+    
+    width_        = info.width;
+    height_       = info.height;
+    video_format_ = GST_VIDEO_INFO_FORMAT(&info);
+    
+    // videoconvert only leaves passthrough when the decoder output had to be converted
+    const bool converted = !gst_base_transform_is_passthrough(GST_BASE_TRANSFORM(video_convert_.get()));
+    if (converted) {
+        video_conversions_++;
+        CASPAR_LOG(info) << "GstInput converting decoded video to " << gst_video_format_to_string(video_format_)
+                         << " for " << srt::redact(uri_);
+    }
+    video_conversion_ = converted;
 }
 
 bool GstInput::try_pop_video(GstSample** sample)
 {
-    auto result = video_buffer_.try_pop(*sample);
-    graph_->set_value("input", static_cast<double>(video_buffer_.size()) / video_buffer_.capacity());
+    bool result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result = video_buffer_.try_pop(*sample);
+        if (result) {
+            const auto popped = video_popped_++;
+            while (!entry_starts_.empty() && entry_starts_.front().first <= popped) {
+                video_entry_ = entry_starts_.front().second;
+                entry_starts_.pop_front();
+            }
+        }
+    }
+    if (result) {
+        // Room for a streaming thread waiting on a full queue
+        cond_.notify_all();
+    }
+    graph()->set_value("input", static_cast<double>(video_buffer_.size()) / video_depth_);
     return result;
 }
 
+bool GstInput::pop_video(GstSample** sample, std::chrono::milliseconds timeout)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // Also return when the audio queue is full so the caller can drain it, otherwise a
+        // blocked audio thread can stall the demuxer feeding video
+        cond_.wait_for(lock, timeout, [&] {
+            return !video_buffer_.empty() || audio_buffer_.size() >= audio_depth_ || wake_ ||
+                   abort_request_;
+        });
+        wake_ = false;
+    }
+    
+    return try_pop_video(sample);
+}
+
+bool GstInput::pop_audio(GstSample** sample, std::chrono::milliseconds timeout)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait_for(lock, timeout, [&] { return !audio_buffer_.empty() || wake_ || abort_request_; });
+    }
+    
+    return try_pop_audio(sample);
+}
+
+void GstInput::wait(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait_for(lock, timeout, [&] { return wake_ || abort_request_; });
+    wake_ = false;
+}
+
+void GstInput::queue_depth(int frames)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        video_depth_ = std::clamp(frames, 1, static_cast<int>(video_buffer_.capacity()));
+        audio_depth_ = std::clamp(frames * 2, 8, static_cast<int>(audio_buffer_.capacity()));
+    }
+    // A larger depth lets waiting streaming threads continue
+    cond_.notify_all();
+}
+
+void GstInput::wake()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_ = true;
+    }
+    cond_.notify_all();
+}
+
+void GstInput::clear(tbb::concurrent_bounded_queue<GstSample*>& queue)
+{
+    GstSample* sample = nullptr;
+    while (queue.try_pop(sample)) {
+        if (sample) {
+            gst_sample_unref(sample);
+        }
+    }
+}
+
 bool GstInput::try_pop_audio(GstSample** sample)
 {
-    return audio_buffer_.try_pop(*sample);
+    bool result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result = audio_buffer_.try_pop(*sample);
+    }
+    if (result) {
+        cond_.notify_all();
+    }
+    return result;
 }
 
-void GstInput::seek(int64_t position, bool flush)
+GstInput::seek_mode GstInput::seek(int64_t position, bool flush)
 {
     if (!pipeline_) {
-        return;
+        return seek_mode::key_unit;
     }
     
     if (position < 0) {
@@ -360,62 +1044,208 @@ void GstInput::seek(int64_t position, bool flush)
     
     CASPAR_LOG(debug) << "GstInput seeking to position: " << position;
     
+    // Seeking fails until the pipeline has prerolled once, the bus thread runs it afterwards
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!prerolled_) {
+            pending_seek_ = position;
+            eof_          = false;
+            return seek_mode::accurate;
+        }
+    }
+    
     // Convert milliseconds to nanoseconds
     gint64 seek_pos = position * GST_MSECOND;
     
-    // Flush the buffers if requested
+    // A key unit seek is exact when the target is a known keyframe, give or take the millisecond
+    // lost in the conversion. Anything else is decoded from the previous keyframe and the decoder
+    // drops the frames before the target without ever outputting them. Fast and reverse rates
+    // only show keyframes, so the decoder skips everything in between.
+    const auto rate     = rate_.load();
+    const auto keyframe = keyframe_before(seek_pos + static_cast<gint64>(GST_MSECOND));
+    auto       mode     = keyframe >= 0 && keyframe >= seek_pos ? seek_mode::key_unit : seek_mode::accurate;
+    if (rate < 0.0 || rate > config().trickmode_threshold) {
+        mode = seek_mode::trickmode;
+    }
     if (flush) {
-        GstSample* sample = nullptr;
-        while (video_buffer_.try_pop(sample)) {
-            if (sample) {
-                gst_sample_unref(sample);
-            }
-        }
-        
-        while (audio_buffer_.try_pop(sample)) {
-            if (sample) {
-                gst_sample_unref(sample);
-            }
-        }
+        std::lock_guard<std::mutex> lock(index_mutex_);
+        run_trickmode_ = mode == seek_mode::trickmode;
+    }
+    
+    // Flags for the seek operation. Queued samples are dropped by the sink probes when the flush
+    // reaches the appsinks. A playlist loops through about-to-finish, a segment would suppress it.
+    const bool segment = loop_ && playlist().empty();
+    int        flags   = (flush ? GST_SEEK_FLAG_FLUSH : GST_SEEK_FLAG_NONE) | (segment ? GST_SEEK_FLAG_SEGMENT : GST_SEEK_FLAG_NONE);
+    switch (mode) {
+        case seek_mode::key_unit:
+            flags |= GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_BEFORE;
+            seek_pos = keyframe;
+            break;
+        case seek_mode::accurate:
+            flags |= GST_SEEK_FLAG_ACCURATE;
+            break;
+        case seek_mode::trickmode:
+            flags |= GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_BEFORE | GST_SEEK_FLAG_TRICKMODE |
+                     GST_SEEK_FLAG_TRICKMODE_KEY_UNITS | GST_SEEK_FLAG_TRICKMODE_NO_AUDIO;
+            break;
     }
     
-    // Flags for the seek operation
-    GstSeekFlags flags = static_cast<GstSeekFlags>(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT);
+    // Forward playback runs from the position to the out point, reverse from the position back
+    // to the in point
+    const auto stop = stop_.load();
     
-    // Perform the seek operation
-    if (!gst_element_seek_simple(pipeline_.get(), GST_FORMAT_TIME, flags, seek_pos)) {
+    gboolean result;
+    if (rate < 0.0) {
+        result = gst_element_seek(pipeline_.get(),
+                                  rate,
+                                  GST_FORMAT_TIME,
+                                  static_cast<GstSeekFlags>(flags),
+                                  GST_SEEK_TYPE_SET,
+                                  static_cast<gint64>(start_ * GST_MSECOND),
+                                  GST_SEEK_TYPE_SET,
+                                  seek_pos);
+    } else {
+        result = gst_element_seek(pipeline_.get(),
+                                  rate,
+                                  GST_FORMAT_TIME,
+                                  static_cast<GstSeekFlags>(flags),
+                                  GST_SEEK_TYPE_SET,
+                                  seek_pos,
+                                  stop >= 0 ? GST_SEEK_TYPE_SET : GST_SEEK_TYPE_NONE,
+                                  stop >= 0 ? static_cast<gint64>(stop * GST_MSECOND) : -1);
+    }
+    
+    if (!result) {
         CASPAR_LOG(warning) << "GstInput seek failed";
     }
     
     eof_ = false;
-    graph_->set_tag(diagnostics::tag_severity::INFO, "seek");
+    graph()->set_tag(diagnostics::tag_severity::INFO, "seek");
+    
+    return mode;
 }
 
-void GstInput::abort()
+void GstInput::seek_before(int64_t position)
 {
-    abort_request_ = true;
+    if (!pipeline_) {
+        return;
+    }
     
-    if (pipeline_) {
-        gst_element_set_state(pipeline_.get(), GST_STATE_NULL);
+    {
+        std::lock_guard<std::mutex> lock(index_mutex_);
+        run_trickmode_ = false;
     }
     
-    GstSample* sample = nullptr;
-    while (video_buffer_.try_pop(sample)) {
-        if (sample) {
-            gst_sample_unref(sample);
-        }
+    const auto flags = static_cast<GstSeekFlags>(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_BEFORE |
+                                                 GST_SEEK_FLAG_TRICKMODE_NO_AUDIO);
+    if (!gst_element_seek(pipeline_.get(),
+                          1.0,
+                          GST_FORMAT_TIME,
+                          flags,
+                          GST_SEEK_TYPE_SET,
+                          std::max<int64_t>(position - 1, 0),
+                          GST_SEEK_TYPE_SET,
+                          std::max<int64_t>(position, 1))) {
+        CASPAR_LOG(warning) << "GstInput seek failed";
     }
     
-    while (audio_buffer_.try_pop(sample)) {
-        if (sample) {
-            gst_sample_unref(sample);
-        }
+    eof_ = false;
+}
+
+bool GstInput::rewind()
+{
+    if (!pipeline_ || network_ || error_ || abort_request_ || !playlist().empty()) {
+        return false;
+    }
+    
+    loop(false);
+    range(0, -1);
+    rate(1.0);
+    stop();
+    seek(0, true);
+    return true;
+}
+
+bool GstInput::reconnect()
+{
+    if (!pipeline_ || abort_request_) {
+        return false;
+    }
+    
+    CASPAR_LOG(debug) << "GstInput reconnecting " << srt::redact(uri_);
+    gst_element_set_state(pipeline_.get(), GST_STATE_READY);
+    
+    // Whatever is still queued belongs to the old connection
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        clear(video_buffer_);
+        clear(audio_buffer_);
+        preroll_pending_ = false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(index_mutex_);
+        run_from_  = -1;
+        run_until_ = -1;
+    }
+    eof_   = false;
+    error_ = false;
+    
+    if (gst_element_set_state(pipeline_.get(), GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+        error_ = true;
+        return false;
     }
+    return true;
+}
+
+std::size_t GstInput::memory_usage() const
+{
+    // The prerolled frame is held as the sample and as the frame converted from it, on top of
+    // that come the demuxer and decoder queues
+    const std::size_t frame_size = static_cast<std::size_t>(width_) * height_ * 4;
+    return frame_size * 2 + 16 * 1024 * 1024;
+}
+
+void GstInput::loop(bool loop)
+{
+    loop_ = loop;
+}
+
+void GstInput::rate(double rate)
+{
+    rate_ = rate != 0.0 ? rate : 1.0;
+}
+
+void GstInput::range(int64_t start, int64_t stop)
+{
+    start_ = std::max<int64_t>(start, 0);
+    stop_  = stop;
+}
+
+void GstInput::abort()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        abort_request_ = true;
+    }
+    cond_.notify_all();
+    
+    if (pipeline_) {
+        gst_element_set_state(pipeline_.get(), GST_STATE_NULL);
+    }
+    
+    clear(video_buffer_);
+    clear(audio_buffer_);
 }
 
 void GstInput::reset()
 {
-    std::lock_guard<std::mutex> lock(mutex_);
+    // Release a streaming thread blocked on a full queue before stopping
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        video_flushing_ = true;
+        audio_flushing_ = true;
+    }
+    cond_.notify_all();
     
     // Stop current pipeline
     if (pipeline_) {
@@ -427,17 +1257,12 @@ void GstInput::reset()
     audio_appsink_.reset();
     
     // Clear buffers
-    GstSample* sample = nullptr;
-    while (video_buffer_.try_pop(sample)) {
-        if (sample) {
-            gst_sample_unref(sample);
-        }
-    }
-    
-    while (audio_buffer_.try_pop(sample)) {
-        if (sample) {
-            gst_sample_unref(sample);
-        }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        clear(video_buffer_);
+        clear(audio_buffer_);
+        video_flushing_ = false;
+        audio_flushing_ = false;
     }
     
     // Reset state
@@ -448,9 +1273,15 @@ void GstInput::reset()
     initialize_pipeline(uri_);
 }
 
+int GstInput::video_queued() const
+{
+    return static_cast<int>(video_buffer_.size());
+}
+
 bool GstInput::eof() const
 {
-    return eof_;
+    // Local sources decode ahead, the frames queued before EOS still have to be played
+    return eof_ && video_buffer_.empty();
 }
 
 int GstInput::width() const
@@ -473,6 +1304,21 @@ int GstInput::audio_sample_rate() const
     return audio_sample_rate_;
 }
 
+GstVideoFormat GstInput::video_format() const
+{
+    return video_format_;
+}
+
+bool GstInput::video_conversion() const
+{
+    return video_conversion_;
+}
+
+int GstInput::video_conversions() const
+{
+    return video_conversions_;
+}
+
 int64_t GstInput::duration() const
 {
     return duration_; // Already stored in milliseconds
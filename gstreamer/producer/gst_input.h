@@ -1,16 +1,24 @@
 #pragma once
 
+#include "gst_video_filter.h"
+
+#include "../util/gst_probe_cache.h"
+#include "../util/gst_srt.h"
+#include "../util/gst_thread_policy.h"
 #include "../util/gst_util.h"
 #include <common/diagnostics/graph.h>
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <queue>
+#include <set>
 #include <string>
 
 #include <tbb/concurrent_queue.h>
@@ -22,23 +30,115 @@ namespace caspar { namespace gstreamer {
 class GstInput
 {
   public:
-    GstInput(const std::string& uri, std::shared_ptr<diagnostics::graph> graph, std::optional<bool> loop = std::nullopt);
+    enum class seek_mode
+    {
+        key_unit, // Target is a known keyframe, decoding starts right there
+        accurate, // Decoder starts at the previous keyframe and drops frames up to the target
+        trickmode, // Fast or reverse playback, only keyframes are decoded
+    };
+    
+    // A live latency (ms) runs network sources in live mode: the sinks don't sync to the clock and
+    // the source buffers only as much as the target latency. The filter chain processes decoded video
+    // on its native format before it is converted. Streaming threads follow the thread policy.
+    GstInput(const std::string&                  uri,
+             std::shared_ptr<diagnostics::graph> graph,
+             std::optional<bool>                 loop   = std::nullopt,
+             std::optional<int64_t>              live   = std::nullopt,
+             std::unique_ptr<GstFilterChain>     filter = nullptr,
+             std::optional<thread_policy>        policy = std::nullopt);
     ~GstInput();
 
     // Get video and audio samples
     bool try_pop_video(GstSample** sample);
     bool try_pop_audio(GstSample** sample);
     
+    // Blocks until a video sample is decoded, wake() is called or the timeout expires
+    bool pop_video(GstSample** sample, std::chrono::milliseconds timeout);
+    
+    // Blocks until an audio sample is decoded, wake() is called or the timeout expires
+    bool pop_audio(GstSample** sample, std::chrono::milliseconds timeout);
+    
+    // Blocks until wake() is called or the timeout expires
+    void wait(std::chrono::milliseconds timeout);
+    void wake();
+    
     // Query pipeline information
     int width() const;
     int height() const;
     int audio_channels() const;
     int audio_sample_rate() const;
     
-    // Control methods
-    void seek(int64_t position, bool flush = true);
+    // Negotiated video format and whether videoconvert had to convert the decoder output
+    GstVideoFormat video_format() const;
+    bool video_conversion() const;
+    int video_conversions() const;
+    
+    // Keyframe index, filled in lazily from the buffers that reach the video decoder. Positions
+    // are stream time in nanoseconds, -1 when nothing before the position has been indexed yet.
+    // Every keyframe is known where the decoder has seen all buffers: from the start of the stream
+    // up to indexed_until(), and in the stretch decoded since the last flush.
+    int64_t keyframe_before(int64_t position) const;
+    int64_t indexed_until() const;
+    bool indexed(int64_t from, int64_t to) const;
+    
+    // Factory name of the video decoder playbin picked, empty until it is created
+    std::string video_decoder() const;
+    
+    // Decoded video samples waiting in the queue
+    int video_queued() const;
+    
+    // Latency the pipeline reports for live sources in nanoseconds, 0 when unknown
+    int64_t latency() const { return latency_; }
+    bool live() const { return live_; }
+    
+    // Sources other than local files
+    bool network() const { return network_; }
+    
+    // Transport statistics of an srt:// source, nothing for other sources or while it is
+    // waiting for a connection
+    std::optional<srt::stats> srt_stats() const;
+    
+    // Whether duration, caps and keyframes were seeded from the probe cache
+    bool cached() const { return cached_; }
+    
+    // Looping and the play range, in milliseconds with -1 for the end of the stream. While looping,
+    // seeks open a segment that ends at the stop position and every SEGMENT_DONE queues the next
+    // iteration without a flush. Changes apply from the next seek.
+    void loop(bool loop);
+    void range(int64_t start, int64_t stop);
+    
+    // Playback rate of the next seek. Moderate rates decode everything and keep the audio pitch
+    // through scaletempo, rates beyond trickmode-threshold and reverse rates decode keyframes only.
+    // Moderate reverse rates are played by GstReverse on top of seek_before() instead.
+    void rate(double rate);
+    double rate() const { return rate_; }
+    
+    // Playlist mode. The entries play back to back in this pipeline: the next one is queued on
+    // about-to-finish so decoders and sinks carry on without a gap. Looping wraps to the first
+    // entry. Entries are local paths or URIs, the first one is the uri the input was opened with.
+    void playlist(std::vector<std::string> entries);
+    void playlist_append(const std::string& entry);
+    bool playlist_remove(std::size_t index);
+    std::vector<std::string> playlist() const;
+    
+    // Playlist entry the video sample popped last belongs to
+    int video_entry() const { return video_entry_; }
+    
+    // Number of decoded video frames local sources are read ahead, audio gets twice as many samples
+    // since those are usually shorter than a frame. Network sources aren't throttled and fill the
+    // queues up to their fixed capacity before dropping.
+    void queue_depth(int frames);
+    
+    // Control methods, position is in milliseconds
+    seek_mode seek(int64_t position, bool flush = true);
+    
+    // Decodes video forwards from the keyframe before 'position' (ns) and stops there, at normal
+    // speed and without looping
+    void seek_before(int64_t position);
     void abort();
     void reset();
+    
+    // End of stream was reached and every decoded frame has been popped
     bool eof() const;
     int64_t duration() const;
     void start();
@@ -50,21 +150,74 @@ class GstInput
     
     // Status information
     bool is_valid() const { return pipeline_ != nullptr; }
+    bool has_error() const { return error_; }
+    
+    // Returns to the start in PAUSED, prerolling the first frame again, so the input can be
+    // parked in the preroll pool. False when it can't be reused.
+    bool rewind();
+    
+    // Reconnects a network source after an error or outage. The pipeline drops to READY, which
+    // tears down source, demuxer and decoders while the sinks, filters and bus watch stay, and
+    // plays again. False when the source fails right away.
+    bool reconnect();
+    
+    // Rough memory held by the input while it is parked
+    std::size_t memory_usage() const;
+    
+    // Diagnostics graph the input reports to, replaced when a pooled input changes producer
+    std::shared_ptr<diagnostics::graph> graph() const;
+    void graph(std::shared_ptr<diagnostics::graph> graph);
     
     // Static callback handlers for AppSink
     static GstFlowReturn new_video_sample(GstAppSink* sink, gpointer user_data);
+    static GstFlowReturn new_video_preroll(GstAppSink* sink, gpointer user_data);
     static GstFlowReturn new_audio_sample(GstAppSink* sink, gpointer user_data);
+    static GstPadProbeReturn sink_event_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn decoder_buffer_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static void element_setup(GstElement* pipeline, GstElement* element, gpointer user_data);
+    static void about_to_finish(GstElement* pipeline, gpointer user_data);
+    static std::string to_uri(const std::string& location);
 
   private:
     void initialize_pipeline(const std::string& uri);
+    void handle_message(GstMessage* msg);
     void create_pipeline(const std::string& uri);
+    void update_video_format(GstCaps* caps);
+    void update_audio_format(GstCaps* caps);
+    void update_duration();
+    void update_latency();
+    void init_graph();
+    void push_video(GstSample* sample, bool preroll);
+    void load_probe_cache();
+    void store_probe_cache();
+    static void clear(tbb::concurrent_bounded_queue<GstSample*>& queue);
     
     std::string                              uri_;
     std::shared_ptr<diagnostics::graph>      graph_;
-    std::optional<bool>                      loop_;
+    std::atomic<bool>                        loop_{false};
+    std::atomic<int64_t>                     start_{0};
+    std::atomic<int64_t>                     stop_{-1};
+    std::atomic<double>                      rate_{1.0};
+    
+    // Playlist, playlist_queued_ is the entry handed to playbin last and playlist_index_ the one
+    // that reached the sinks
+    mutable std::mutex                       playlist_mutex_;
+    std::vector<std::string>                 playlist_;
+    int                                      playlist_queued_ = 0;
+    std::atomic<int>                         playlist_index_{0};
+    
+    // Video samples queued so far and popped so far, and the count at which each entry that
+    // reached the video sink starts. Guarded by mutex_.
+    uint64_t                                 video_pushed_ = 0;
+    uint64_t                                 video_popped_ = 0;
+    std::deque<std::pair<uint64_t, int>>     entry_starts_;
+    std::atomic<int>                         video_entry_{0};
 
     // Pipeline elements
+    std::unique_ptr<GstFilterChain>          filter_;
+    std::optional<thread_policy>             policy_;
     gst_ptr<GstElement>                      pipeline_;
+    gst_ptr<GstElement>                      video_convert_;
     gst_ptr<GstElement>                      video_appsink_;
     gst_ptr<GstElement>                      audio_appsink_;
     
@@ -76,6 +229,11 @@ class GstInput
     std::atomic<bool>                        initialized_{false};
     std::atomic<bool>                        eof_{false};
     std::atomic<bool>                        abort_request_{false};
+    std::atomic<bool>                        error_{false};
+    bool                                     network_ = false;
+    int64_t                                  live_latency_ = -1; // ms
+    bool                                     live_         = false;
+    std::atomic<int64_t>                     latency_{0};
     
     // Stream info
     std::atomic<int>                         width_{0};
@@ -84,12 +242,52 @@ class GstInput
     std::atomic<int>                         audio_sample_rate_{0};
     std::atomic<int64_t>                     duration_{0};  // Store in milliseconds instead of GstClockTime
     
-    // Synchronization
+    // Negotiated video format, only written from the video streaming thread
+    gst_ptr<GstCaps>                         video_caps_;
+    std::atomic<GstVideoFormat>              video_format_{GST_VIDEO_FORMAT_UNKNOWN};
+    std::atomic<bool>                        video_conversion_{false};
+    std::atomic<int>                         video_conversions_{0};
+    
+    // Negotiated audio format, only written from the audio streaming thread
+    gst_ptr<GstCaps>                         audio_caps_;
+    
+    // Keyframe index, written from the demuxer streaming thread
+    mutable std::mutex                       index_mutex_;
+    std::set<int64_t>                        keyframes_;
+    int64_t                                  indexed_until_ = -1; // Decoded without a gap from the start
+    bool                                     index_reset_   = false; // The next clip starts a new index
+    GstPad*                                  index_pad_     = nullptr; // Decoder pad of the indexed clip, compared only
+    
+    // Stretch decoded without a gap since the last flush, run_from_ is -1 until its first buffer.
+    // The first stretch after opening starts at the start of the stream.
+    int64_t                                  run_from_      = 0;
+    int64_t                                  run_until_     = -1;
+    bool                                     run_trickmode_ = false;
+    std::string                              video_decoder_;
+    gst_ptr<GstElement>                      srt_source_; // Replaced when a reconnect creates a new one
+    
+    // Probe cache state, indexed_until_ and duration as they were loaded
+    std::optional<probe_cache::file_stamp>   probe_stamp_; // The file as it was when loading started
+    bool                                     cached_             = false;
+    int64_t                                  cached_until_       = -1;
+    int64_t                                  cached_duration_    = 0;
+    
+    // Synchronization, guards the flags below and signals queue changes in both directions.
+    // preroll_pts_ identifies the prerolled buffer so it isn't queued twice when rendered.
     mutable std::mutex                       mutex_;
     std::condition_variable                  cond_;
+    bool                                     wake_            = false;
+    int                                      video_depth_     = 64;
+    int                                      audio_depth_     = 128;
+    bool                                     video_flushing_  = false;
+    bool                                     audio_flushing_  = false;
+    bool                                     prerolled_       = false;
+    int64_t                                  pending_seek_    = -1;
+    bool                                     preroll_pending_ = false;
+    GstClockTime                             preroll_pts_     = GST_CLOCK_TIME_NONE;
     
-    // Monitoring thread
-    boost::thread                            thread_;
+    // Bus messages, see handle_message()
+    std::shared_ptr<void>                    bus_watch_;
 };
 
 }} // namespace caspar::gstreamer
@@ -0,0 +1,85 @@
+#include "gst_preroll_pool.h"
+
+#include "../util/gst_config.h"
+#include "../util/gst_teardown.h"
+
+#include <common/diagnostics/graph.h>
+#include <common/log.h>
+
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <vector>
+
+namespace caspar { namespace gstreamer { namespace preroll_pool {
+
+namespace {
+
+struct entry
+{
+    std::string               key;
+    std::shared_ptr<GstInput> input;
+    std::size_t               memory;
+};
+
+std::mutex       g_mutex;
+std::list<entry> g_entries; // Most recently parked first
+std::size_t      g_memory = 0;
+
+} // namespace
+
+std::shared_ptr<GstInput> take(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    auto it = std::find_if(g_entries.begin(), g_entries.end(), [&](const entry& e) { return e.key == key; });
+    if (it == g_entries.end()) {
+        return nullptr;
+    }
+
+    auto input = std::move(it->input);
+    g_memory -= it->memory;
+    g_entries.erase(it);
+
+    CASPAR_LOG(debug) << "[gstreamer] Reusing prerolled input for " << key;
+    return input;
+}
+
+void park(const std::string& key, std::shared_ptr<GstInput> input)
+{
+    if (!input) {
+        return;
+    }
+
+    if (config().preroll_pool_size <= 0 || !input->rewind()) {
+        teardown::post([input] { input->abort(); });
+        return;
+    }
+
+    // Detach from the producer that is going away
+    input->graph(std::make_shared<diagnostics::graph>());
+
+    std::vector<std::shared_ptr<GstInput>> evicted;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+
+        const auto memory = input->memory_usage();
+        g_entries.push_front(entry{key, std::move(input), memory});
+        g_memory += memory;
+
+        const auto max_size   = static_cast<std::size_t>(config().preroll_pool_size);
+        const auto max_memory = static_cast<std::size_t>(config().preroll_pool_memory) * 1024 * 1024;
+        while (!g_entries.empty() && (g_entries.size() > max_size || g_memory > max_memory)) {
+            g_memory -= g_entries.back().memory;
+            evicted.push_back(std::move(g_entries.back().input));
+            g_entries.pop_back();
+        }
+    }
+
+    // Pipelines are torn down outside the lock, this can take a while
+    for (auto& e : evicted) {
+        teardown::post([e = std::move(e)] { e->abort(); });
+    }
+}
+
+}}} // namespace caspar::gstreamer::preroll_pool
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "gst_input.h"
+
+#include <memory>
+#include <string>
+
+namespace caspar { namespace gstreamer {
+
+// Inputs of finished producers, rewound and prerolled in PAUSED with their first frame queued.
+// A producer for the same source takes one over instead of building a cold pipeline, so demuxer
+// probing, plugin loading and decoder setup are skipped.
+//
+// The pool is bounded by preroll-pool-size and preroll-pool-memory, the least recently parked
+// inputs are evicted first.
+namespace preroll_pool {
+
+// A parked input for the key, or nullptr
+std::shared_ptr<GstInput> take(const std::string& key);
+
+// Rewinds and parks the input, or tears it down when it can't be reused
+void park(const std::string& key, std::shared_ptr<GstInput> input);
+
+} // namespace preroll_pool
+
+}} // namespace caspar::gstreamer
@@ -1,9 +1,20 @@
 #include "gst_producer.h"
+#include "gst_audio_buffer.h"
 #include "gst_input.h"
+#include "gst_preroll_pool.h"
+#include "gst_reverse.h"
+#include "gst_video_filter.h"
 
 #include "../util/gst_assert.h"
+#include "../util/gst_config.h"
+#include "../util/gst_srt.h"
+#include "../util/gst_task_pool.h"
+#include "../util/gst_teardown.h"
+#include "../util/gst_thread_policy.h"
 #include "../util/gst_util.h"
+#include "../util/spsc_ring.h"
 
+#include <boost/filesystem.hpp>
 #include <boost/format.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/range/algorithm/rotate.hpp>
@@ -22,29 +33,70 @@
 
 #include <algorithm>
 #include <atomic>
-#include <deque>
+#include <cmath>
 #include <iomanip>
 #include <memory>
 #include <sstream>
 #include <thread>
+#include <utility>
 
 namespace caspar { namespace gstreamer {
 
 struct Frame
 {
-    GstSample*              video = nullptr;
-    GstSample*              audio = nullptr;
     core::draw_frame        frame;
     int64_t                 start_time  = 0;
     int64_t                 pts         = 0;
     int64_t                 duration    = 0;
     int64_t                 frame_count = 0;
+    uint64_t                epoch       = 0;
+    int                     entry       = 0; // Playlist entry
+};
+
+// Exponentially weighted mean and variance of a measurement, in seconds
+struct Ewma
+{
+    double mean  = 0.0;
+    double var   = 0.0;
+    bool   empty = true;
+
+    void add(double value, double alpha = 0.05)
+    {
+        if (empty) {
+            mean  = value;
+            empty = false;
+            return;
+        }
+        const auto delta = value - mean;
+        mean += alpha * delta;
+        var = (1.0 - alpha) * (var + alpha * delta * delta);
+    }
+
+    double stddev() const { return std::sqrt(var); }
+};
+
+// A converted frame and where it sits on the running time axis
+struct Source
+{
+    core::draw_frame frame;
+    int64_t          running_time = 0;
+    int64_t          duration     = 0;
+    int64_t          pts          = 0;
+    double           rate         = 1.0;
+
+    // Stream time shown at 'time' on the running time axis, which runs at normal speed whatever
+    // the playback rate
+    int64_t position(int64_t time) const
+    {
+        return pts + static_cast<int64_t>(static_cast<double>(std::max<int64_t>(time - running_time, 0)) * rate);
+    }
 };
 
 struct GstProducer::Impl
 {
     caspar::core::monitor::state state_;
     mutable boost::mutex         state_mutex_;
+    timer                        media_state_timer_; // Producer thread, see update_media_state()
 
     spl::shared_ptr<diagnostics::graph> graph_;
 
@@ -52,31 +104,115 @@ struct GstProducer::Impl
     const core::video_format_desc              format_desc_;
     const std::string                          name_;
     const std::string                          path_;
-
-    GstInput                input_;
+    std::string                                pool_key_; // Taken when created, see pool_key()
+
+    // The input is opened on the producer thread so creating the producer doesn't wait for the
+    // pipeline, see open(). Until opened_ is set other threads leave input_ alone and keep the
+    // playlist and rate they are given in the pending fields, guarded by open_mutex_.
+    std::shared_ptr<GstInput> input_;
+    std::atomic<bool>         opened_{false};
+    std::atomic<bool>         open_failed_{false};
+    mutable boost::mutex      open_mutex_;
+    std::vector<std::string>  pending_playlist_;
+    std::optional<double>     pending_rate_;
+
+    // Cost of the open in ms since the producer was created, -1 until reached
+    timer                   open_timer_;
+    std::atomic<int64_t>    open_pipeline_ms_{-1};
+    std::atomic<int64_t>    open_preroll_ms_{-1};
+    std::atomic<int64_t>    open_first_frame_ms_{-1};
+
+    GstAudioBuffer          audio_;
     std::string             vfilter_;
 
     std::atomic<int64_t>    start_{0};
     std::atomic<int64_t>    duration_{std::numeric_limits<int64_t>::max()};
-    std::atomic<int64_t>    input_duration_{0};
     std::atomic<int64_t>    seek_{-1};
     std::atomic<bool>       loop_{false};
 
+    // Live mode target latency in frames, -1 when off. Frames beyond it are dropped, see run().
+    const int               live_latency_;
+    timer                   live_timer_;
+    int64_t                 live_dropped_ = 0;
+
+    // Network outages, see check_network(). The render thread holds the last frame while
+    // outage_ is set, the rest is producer thread only.
+    std::atomic<bool>       outage_{false};
+    timer                   outage_timer_;
+    timer                   reconnect_timer_;
+    int64_t                 reconnect_delay_ = 0; // ms
+    timer                   stall_timer_;
+    std::atomic<int64_t>    reconnects_{0};
+    std::atomic<int64_t>    outage_ms_{0}; // Current or last outage
+    timer                   srt_timer_;    // Transport statistics are read once a second, under state_mutex_
+
+    // Decoded video is filtered, cropped and scaled for the channel in the pipeline, see GstFilterChain
     core::frame_geometry::scale_mode scale_mode_;
+    const std::string                scaler_;
     int64_t                          frame_count_    = 0;
-    bool                             frame_flush_    = true;
-    int64_t                          frame_time_     = 0;
+    int                              frame_entry_    = 0; // Playlist entry of the last converted frame
+    std::atomic<int>                 on_air_entry_{0};    // Playlist entry of the frame on air
+    std::atomic<bool>                frame_flush_{true};
+    std::atomic<int64_t>             frame_time_{0};
     int64_t                          frame_duration_ = 0;
     core::draw_frame                 frame_;
+    std::atomic<bool>                has_frame_{false};
+    std::atomic<bool>                playing_{false};
+
+    // Decoded frames travel from the producer thread to the render thread through a wait-free
+    // ring. Seeks bump epoch_ and the render thread skips frames tagged with an older epoch.
+    // The ring is sized for buffer-max, the producer only fills it up to buffer_depth_.
+    const int                       buffer_min_ = config().buffer_min;
+    const int                       buffer_max_ = config().buffer_max;
+    std::atomic<int>                buffer_depth_{clamp_depth(static_cast<int>(format_desc_.fps) / 4)};
+    spsc_ring<Frame>                buffer_{static_cast<std::size_t>(buffer_max_)};
+    std::atomic<uint64_t>           epoch_{0};
+    std::atomic<bool>               buffer_eof_{false};
 
-    std::deque<Frame>               buffer_;
-    mutable boost::mutex            buffer_mutex_;
+    // Only used by the producer thread to wait for room in the ring
+    boost::mutex                    buffer_mutex_;
     boost::condition_variable       buffer_cond_;
-    std::atomic<bool>               buffer_eof_{false};
-    int                             buffer_capacity_ = static_cast<int>(format_desc_.fps) / 4;
+    std::atomic<bool>               buffer_waiting_{false};
+
+    // Frame rate conversion, producer thread only. Decoded frames are mapped onto channel ticks
+    // starting at tick_base_ (running time), see schedule().
+    const bool                      blend_;
+    std::vector<int>                audio_cadence_;
+    int64_t                         tick_base_   = -1;
+    int64_t                         tick_        = 0;
+    Source                          source_;
+    uint64_t                        frame_epoch_ = 0;
+    timer                           frame_timer_;
+    std::atomic<int64_t>            rate_dropped_{0};
+    std::atomic<int64_t>            rate_repeated_{0};
+    std::atomic<int64_t>            field_slips_{0}; // Render thread
+    std::atomic<field_order>        field_order_{field_order::progressive};
+
+    // Seek bookkeeping, producer thread only. Decoded frames before seek_target_ (ns) are
+    // skipped before they are converted.
+    int64_t                         seek_target_    = -1;
+    int64_t                         last_pts_       = -1;
+    int64_t                         seek_discarded_ = 0;
+    bool                            seek_pending_   = false;
+    double                          seek_rate_      = 1.0; // Rate of the last seek on the input
+    int64_t                         reverse_from_   = -1;  // Position run_reverse() starts from
+    std::string                     seek_mode_;
+    timer                           seek_timer_;
+
+    // Buffer depth adaption, see update_depth(). Underflows are counted by the render thread,
+    // the rest is producer thread only.
+    std::atomic<int>                underflows_{0};
+    int                             depth_floor_ = 0;
+    timer                           depth_timer_;
+    Ewma                            convert_time_;
+    Ewma                            arrival_time_;
 
     caspar::executor                executor_ { L"gstreamer_producer" };
 
+    // Scheduling of the producer thread and the streaming threads of the input
+    const std::optional<thread_policy> policy_;
+    std::atomic<bool>                  policy_applied_{false};
+
     int latency_ = 0;
 
     boost::thread thread_;
@@ -90,38 +226,86 @@ struct GstProducer::Impl
          std::optional<int64_t>               seek,
          std::optional<int64_t>               duration,
          std::optional<bool>                  loop,
-         core::frame_geometry::scale_mode     scale_mode)
+         core::frame_geometry::scale_mode     scale_mode,
+         std::vector<std::string>             playlist,
+         std::optional<int>                   live,
+         bool                                 blend,
+         std::string                          scaler,
+         std::optional<thread_policy>         policy)
         : frame_factory_(frame_factory)
         , format_desc_(format_desc)
-        , name_(name)
+        , name_(srt::redact(name))
         , path_(path)
-        , input_(path, graph_)
+        , audio_(format_desc_)
         , vfilter_(vfilter)
         , start_(start.value_or(0))
         , duration_(duration.value_or(std::numeric_limits<int64_t>::max()))
         , loop_(loop.value_or(false))
+        , live_latency_(live ? std::max(*live, 1) : -1)
         , scale_mode_(scale_mode)
+        , scaler_(std::move(scaler))
+        , blend_(blend)
+        , audio_cadence_(format_desc_.audio_cadence)
+        , policy_(std::move(policy))
     {
+        boost::range::rotate(audio_cadence_, std::end(audio_cadence_) - 1);
+
         diagnostics::register_graph(graph_);
         graph_->set_color("underflow", diagnostics::color(0.6f, 0.3f, 0.9f));
         graph_->set_color("frame-time", diagnostics::color(0.0f, 1.0f, 0.0f));
         graph_->set_color("buffer", diagnostics::color(1.0f, 1.0f, 0.0f));
+        graph_->set_color("seek-time", diagnostics::color(0.2f, 0.6f, 1.0f));
+
+        // A pooled input is already prerolled and used right away. Otherwise the producer thread
+        // builds the pipeline, which prerolls in PAUSED. Either way it only starts playing with
+        // the first take.
+        pending_playlist_     = std::move(playlist);
+        pool_key_             = pool_key();
+        auto pooled           = preroll_pool::take(pool_key_);
+        state_["file/pooled"] = pooled != nullptr;
+        if (pooled) {
+            pooled->graph(graph_);
+            publish(std::move(pooled));
+            open_pipeline_ms_ = 0;
+        }
 
         state_["file/name"] = u8(name_);
-        state_["file/path"] = u8(path_);
+        state_["file/path"] = u8(srt::redact(path_));
         state_["loop"]      = loop_;
+        if (policy_) {
+            state_["policy/name"] = thread_policies::describe(*policy_);
+        }
         update_state();
+        update_media_state();
 
-        input_.start();
-
-        // If we have a specific seek position
+        // If we have a specific seek position. Looping always starts with a seek so the first
+        // iteration already runs in a segment.
         if (seek && *seek > 0) {
             seek_ = *seek;
+        } else if (loop_) {
+            seek_ = start_.load();
         }
 
         thread_ = boost::thread([=] {
             try {
                 set_thread_name(L"[gstreamer::producer]");
+                if (policy_) {
+                    policy_applied_ = thread_policies::apply(*policy_);
+                }
+                if (!opened_) {
+                    try {
+                        open();
+                    } catch (boost::thread_interrupted&) {
+                        throw;
+                    } catch (...) {
+                        // A bad URI or a missing element, the layer plays nothing instead of waiting
+                        CASPAR_LOG_CURRENT_EXCEPTION();
+                        CASPAR_LOG(error) << print() << " Open failed, pipeline could not be created";
+                        open_failed_ = true;
+                        update_state();
+                        return;
+                    }
+                }
                 run();
             } catch (boost::thread_interrupted&) {
                 // Do nothing...
@@ -136,98 +320,789 @@ struct GstProducer::Impl
         try {
             if (thread_.joinable()) {
                 thread_.interrupt();
+                if (opened_) {
+                    input_->wake();
+                }
                 thread_.join();
             }
         } catch (boost::thread_interrupted&) {
             // Do nothing...
         }
 
-        input_.abort();
+        // Let a pending start() run before the input is rewound, then hand it to the pool
+        executor_.invoke([] {});
+        preroll_pool::park(pool_key_, std::move(input_));
     }
 
-    void run()
+    // Producer thread only: builds the pipeline and hands it to the other threads
+    void open()
     {
-        std::vector<int> audio_cadence = format_desc_.audio_cadence;
-        boost::range::rotate(audio_cadence, std::end(audio_cadence) - 1);
+        std::optional<int64_t> live_latency;
+        if (live_latency_ >= 0) {
+            live_latency = frames_to_ns(live_latency_) / static_cast<int64_t>(GST_MSECOND);
+        }
+        publish(std::make_shared<GstInput>(path_,
+                                           graph_,
+                                           std::nullopt,
+                                           live_latency,
+                                           std::make_unique<GstFilterChain>(vfilter_, format_desc_, scale_mode_, scaler_),
+                                           policy_));
+        open_pipeline_ms_ = elapsed_ms(open_timer_);
+        update_state();
+        update_media_state();
+    }
 
-        Frame frame;
-        timer frame_timer;
+    void publish(std::shared_ptr<GstInput> input)
+    {
+        input->queue_depth(buffer_depth_);
+        {
+            boost::lock_guard<boost::mutex> lock(open_mutex_);
+            if (!pending_playlist_.empty()) {
+                input->playlist(std::move(pending_playlist_));
+            }
+            if (pending_rate_) {
+                input->rate(*pending_rate_);
+                if (seek_ < 0) {
+                    seek_ = start_.load();
+                }
+            }
+            input_  = std::move(input);
+            opened_ = true;
+        }
 
-        int warning_debounce = 0;
+        // Loop and in/out changes made before opened_ was set were not handed over
+        update_range();
+    }
+
+    // Fails the open when the pipeline could not be built or reported an error, or nothing was
+    // decoded before open-timeout passed. A clip that ends before its first frame did open.
+    bool open_expired()
+    {
+        if (open_first_frame_ms_ >= 0) {
+            return false;
+        }
+
+        // Network inputs that are down or still waiting for a caller are check_network()'s to
+        // reconnect, they have no deadline
+        std::string reason;
+        if (!input_->is_valid() || (input_->has_error() && !input_->network())) {
+            reason = "pipeline failed";
+        } else if (config().open_timeout > 0 && elapsed_ms(open_timer_) > config().open_timeout &&
+                   !input_->eof() && !input_->network()) {
+            reason = "no frame within " + std::to_string(config().open_timeout) + " ms";
+        } else {
+            return false;
+        }
+
+        CASPAR_LOG(error) << print() << " Open failed, " << reason;
+        open_failed_ = true;
+        update_state();
+        return true;
+    }
+
+    static int64_t elapsed_ms(const timer& t) { return static_cast<int64_t>(t.elapsed() * 1000.0); }
+
+    // Network sources that fail, end without a known duration or stop delivering for
+    // stall-timeout are reconnected. The first attempt is immediate, further ones back off from
+    // reconnect-delay to reconnect-max-delay for as long as no frame arrives. Sources that wait
+    // for data pick up as soon as the feed returns, others with the next attempt.
+    void check_network()
+    {
+        if (!playing_ || input_->eof()) {
+            stall_timer_.restart();
+        }
+
+        if (!outage_) {
+            std::string reason;
+            if (input_->has_error()) {
+                reason = "error";
+            } else if (input_->eof() && input_->duration() == 0) {
+                reason = "end of stream";
+            } else if (config().stall_timeout > 0 && elapsed_ms(stall_timer_) > config().stall_timeout) {
+                reason = "no data for " + std::to_string(elapsed_ms(stall_timer_)) + " ms";
+            } else {
+                return;
+            }
+
+            CASPAR_LOG(warning) << print() << " Network input lost (" << reason << "), reconnecting";
+            outage_          = true;
+            reconnect_delay_ = 0;
+            outage_timer_.restart();
+            reconnect_timer_.restart();
+        }
+
+        outage_ms_ = elapsed_ms(outage_timer_);
+
+        const auto wait = reconnect_delay_ - elapsed_ms(reconnect_timer_);
+        if (wait > 0) {
+            // A failed source has nothing to decode, sleep instead of polling it
+            if (input_->has_error()) {
+                input_->wait(std::chrono::milliseconds(wait));
+            }
+            return;
+        }
+
+        reconnects_++;
+        input_->reconnect();
+        reconnect_timer_.restart();
+        stall_timer_.restart();
+        reconnect_delay_ = std::min(std::max(reconnect_delay_ * 2, static_cast<int64_t>(config().reconnect_delay)),
+                                    static_cast<int64_t>(config().reconnect_max_delay));
+
+        // Running time starts over with the new connection
+        tick_base_ = -1;
+        source_    = Source{};
+        audio_.clear();
+    }
+
+    void run()
+    {
+        timer arrival_timer;
+
+        int  warning_debounce = 0;
+        bool out_reached      = false;
 
         while (!thread_.interruption_requested()) {
+            if (open_expired()) {
+                return;
+            }
+
+            if (media_state_timer_.elapsed() > 0.1) {
+                media_state_timer_.restart();
+                update_media_state();
+            }
+
             {
                 const auto seek_pos = seek_.exchange(-1);
                 if (seek_pos >= 0) {
-                    // Perform seek
-                    input_.seek(seek_pos);
-                    frame = Frame{};
+                    // Perform seek, frames decoded from here on belong to the new epoch
+                    frame_epoch_ = epoch_;
+                    seek_to(seek_pos);
                     frame_flush_ = true;
+                    out_reached  = false;
                     continue;
                 }
             }
 
-            // Check if we've reached the end of the clip
-            {
-                auto start = start_.load();
-                auto duration = duration_.load();
+            if (reverse_from_ >= 0) {
+                run_reverse(std::exchange(reverse_from_, -1));
+                continue;
+            }
 
-                auto end = (duration != std::numeric_limits<int64_t>::max()) ? start + duration : INT64_MAX;
-                auto time = frame.pts + frame.duration;
-                
-                buffer_eof_ = input_.eof() || time >= end;
+            if (input_->network()) {
+                check_network();
+            }
+
+            // Check if we've reached the end of the clip. The input stops at the out point by itself
+            // and loops through segment seeks, so this only restarts playback when looping was
+            // enabled or the out point moved after the last seek.
+            {
+                buffer_eof_ = input_->eof() || out_reached;
 
                 if (buffer_eof_) {
+                    // The last frame still owns the ticks up to its end
+                    flush_source();
+
                     if (loop_ && frame_count_ > 2) {
-                        frame = Frame{};
-                        input_.seek(start);
+                        seek_to(start_);
                         frame_flush_ = true;
+                        out_reached  = false;
                     } else {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                        // Idle until a seek or a loop/in/out change wakes us
+                        input_->wait(std::chrono::milliseconds(500));
                     }
                     continue;
                 }
             }
 
-            // Get a video sample from GStreamer
+            drain_audio();
+
+            // Get a video sample from GStreamer, blocking until one is decoded
             GstSample* video_sample = nullptr;
-            if (input_.try_pop_video(&video_sample)) {
+            if (input_->pop_video(&video_sample, std::chrono::milliseconds(100))) {
                 if (video_sample) {
-                    // Create a new frame
-                    frame.video = video_sample;
-                    
+                    // The converted frame keeps its own reference to the sample
+                    CASPAR_SCOPE_EXIT { gst_sample_unref(video_sample); };
+
+                    // The first sample is the preroll, or the first live frame
+                    if (open_preroll_ms_ < 0) {
+                        open_preroll_ms_ = elapsed_ms(open_timer_);
+                    }
+                    stall_timer_.restart();
+
+                    // Spacing of decoded frames, a steady source delivers one per frame period.
+                    // Restarts after seeks, eof and outages would only measure the gap, skip those.
+                    if (!frame_flush_ && !outage_) {
+                        arrival_time_.add(arrival_timer.elapsed());
+                    }
+                    arrival_timer.restart();
+
+                    // Live sources are held at the target latency by dropping the oldest frames
+                    // before they are converted. Short bursts pass, a backlog that persists for
+                    // half a second is cut in one go.
+                    if (input_->live()) {
+                        const auto backlog = static_cast<int>(buffer_.size()) + input_->video_queued();
+                        if (backlog <= live_latency_) {
+                            live_timer_.restart();
+                        } else if (live_timer_.elapsed() > 0.5) {
+                            live_dropped_++;
+                            continue;
+                        }
+                    }
+
                     // Extract timing information
                     GstBuffer* buffer = gst_sample_get_buffer(video_sample);
-                    frame.pts = GST_BUFFER_PTS(buffer) / 1000000; // Convert from ns to ms
-                    frame.duration = format_desc_.duration;
-                    
-                    // Convert to a CasparCG frame
-                    frame.frame = core::draw_frame(make_frame(this, *frame_factory_, video_sample));
-                    frame.frame_count = frame_count_++;
+                    const auto pts = GST_CLOCK_TIME_IS_VALID(GST_BUFFER_PTS(buffer))
+                                         ? static_cast<int64_t>(GST_BUFFER_PTS(buffer))
+                                         : int64_t{-1};
                     
-                    // Add to buffer
-                    {
-                        boost::unique_lock<boost::mutex> buffer_lock(buffer_mutex_);
-                        buffer_cond_.wait(buffer_lock, [&] { return buffer_.size() < buffer_capacity_; });
-                        if (seek_ == -1) {
-                            buffer_.push_back(frame);
+                    // Frames between the keyframe the decoder started from and the seek target
+                    // are dropped here, before paying for conversion
+                    if (seek_target_ >= 0) {
+                        if (pts >= 0 && pts + static_cast<int64_t>(GST_MSECOND) <= seek_target_) {
+                            seek_discarded_++;
+                            continue;
                         }
+                        seek_target_ = -1;
                     }
+                    last_pts_ = pts;
                     
-                    graph_->set_value("buffer", static_cast<double>(buffer_.size()) / static_cast<double>(buffer_capacity_));
-                    graph_->set_value("frame-time", frame_timer.elapsed() * format_desc_.fps * 0.5);
-                    frame_timer.restart();
-                    
-                    // Clear frame to prepare for next
-                    frame = Frame{};
+                    if (pts >= 0 && pts >= end_ns()) {
+                        out_reached = true;
+                        continue;
+                    }
+
+                    schedule(video_sample, pts);
+
+                    // Time spent waiting for room in the buffer isn't a stall
+                    stall_timer_.restart();
                 }
-            } else {
-                if (warning_debounce++ % 500 == 100) {
-                    CASPAR_LOG(warning) << print() << " Waiting for video frame...";
+                warning_debounce = 0;
+            } else if (playing_ && !input_->eof() && !outage_ && warning_debounce++ % 50 == 10) {
+                // Nothing decoded within the timeout, roughly one warning every five seconds
+                CASPAR_LOG(warning) << print() << " Waiting for video frame...";
+            }
+        }
+    }
+
+    // Maps a decoded frame onto the channel ticks its display interval covers. Ticks are laid
+    // out on the running time axis, which unlike the timestamps keeps increasing across loop
+    // points, so a 25p clip fills two ticks of a 50p channel and a 59.94p clip skips a frame now
+    // and then on 50p. Frames that cover no tick are dropped before they are converted. In blend
+    // mode a frame is held until the next one arrives and the ticks in between mix the two.
+    void schedule(GstSample* sample, int64_t pts)
+    {
+        GstBuffer* buffer   = gst_sample_get_buffer(sample);
+        auto       duration = GST_BUFFER_DURATION_IS_VALID(buffer) && GST_BUFFER_DURATION(buffer) > 0
+                                  ? static_cast<int64_t>(GST_BUFFER_DURATION(buffer))
+                                  : ticks_to_ns(1);
+
+        // Untimed frames get one tick each
+        auto running_time = sample_running_time(sample);
+        if (running_time < 0) {
+            running_time = tick_base_ >= 0 ? tick_time(tick_) : 0;
+            duration     = ticks_to_ns(1);
+        }
+
+        // Start a new timeline after seeks and on jumps the ticks can't bridge. On interlaced
+        // channels it starts on the first field.
+        if (tick_base_ < 0 || std::abs(tick_time(tick_) - running_time) > static_cast<int64_t>(GST_SECOND)) {
+            tick_base_ = running_time;
+            tick_      = 0;
+            source_    = Source{};
+            frame_count_ += frame_count_ % format_desc_.field_count;
+        }
+
+        // Interlaced frames pass through interlaced channels field by field without being
+        // deinterlaced. The woven frame is queued for two ticks and the mixer keeps the lines of
+        // each tick's field, so the frame starts on the tick of its first field, a field later
+        // when the parity doesn't match.
+        field_order_ = native_fields(sample);
+        if (field_order_ != field_order::progressive) {
+            int64_t first = 0;
+            while (tick_time(tick_ + first) < running_time - ticks_to_ns(1) / 2) {
+                first++;
+            }
+            const bool top = (frame_count_ + first) % 2 == 0;
+            running_time   = tick_time(tick_ + first);
+            if (top != (field_order_ == field_order::top_first)) {
+                running_time = tick_time(tick_ + first + 1);
+            }
+        }
+
+        if (!blend_) {
+            // Ticks before this frame keep showing the previous one
+            while (source_.frame && tick_time(tick_) < running_time) {
+                rate_repeated_++;
+                if (!emit(source_.frame, source_.position(tick_time(tick_)))) {
+                    return;
                 }
-                
-                // No frame available yet, sleep and try again
-                std::this_thread::sleep_for(std::chrono::milliseconds(warning_debounce > 25 ? 20 : 5));
+            }
+        }
+
+        // Ticks left up to the end of this frame. When blending that includes the ticks it is
+        // mixed into, the held frame never lags behind the next tick.
+        int64_t covered = 0;
+        while (tick_time(tick_ + covered) < running_time + duration) {
+            covered++;
+        }
+        if (covered == 0) {
+            rate_dropped_++;
+            return;
+        }
+
+        timer convert_timer;
+
+        auto converted = convert(sample);
+        frame_entry_   = input_->video_entry();
+
+        convert_time_.add(convert_timer.elapsed());
+        update_depth();
+
+        Source next;
+        next.running_time = running_time;
+        next.duration     = duration;
+        next.pts          = pts;
+        next.rate         = seek_rate_;
+
+        if (blend_) {
+            next.frame = core::draw_frame(std::move(converted));
+
+            // The held frame owns the ticks up to this one, fading towards it
+            if (source_.frame) {
+                const auto span = std::max<int64_t>(running_time - source_.running_time, 1);
+                while (tick_time(tick_) < running_time) {
+                    const auto at    = tick_time(tick_);
+                    const auto alpha = static_cast<double>(at - source_.running_time) / span;
+                    if (!emit(mix(source_.frame, next.frame, alpha), source_.position(at))) {
+                        return;
+                    }
+                }
+            }
+            source_ = std::move(next);
+            return;
+        }
+
+        source_ = std::move(next);
+        if (!emit_first(std::move(converted), source_.position(tick_time(tick_)), source_.frame)) {
+            return;
+        }
+        for (int64_t n = 1; n < covered; ++n) {
+            rate_repeated_++;
+            if (!emit(source_.frame, source_.position(tick_time(tick_)))) {
+                break;
+            }
+        }
+    }
+
+    // Moderate reverse rates. The frame shown on each tick is looked up backwards from the start
+    // position and only converted when it changes. Runs until a seek or rate change.
+    void run_reverse(int64_t from)
+    {
+        const auto rate = input_->rate();
+
+        GstReverse reverse(input_, from, frames_to_ns(start_), static_cast<std::size_t>(config().reverse_cache) * 1024 * 1024);
+
+        // Ticks only time the audio here, which is silence
+        tick_base_ = 0;
+        tick_      = 0;
+
+        gst_ptr<GstSample> shown;
+        core::draw_frame   video;
+
+        while (!thread_.interruption_requested() && seek_ == -1) {
+            const auto position = from + static_cast<int64_t>(static_cast<double>(ticks_to_ns(tick_)) * rate);
+
+            gst_ptr<GstSample> sample;
+            const auto         status = reverse.frame_at(position, sample);
+
+            if (status == GstReverse::status::pending) {
+                continue;
+            }
+            if (status == GstReverse::status::end) {
+                // Hold the first frame until the next seek or rate change
+                buffer_eof_ = true;
+                input_->wait(std::chrono::milliseconds(100));
+                continue;
+            }
+
+            if (sample != shown) {
+                timer convert_timer;
+                video = core::draw_frame(convert(sample.get()));
+                shown = sample;
+                convert_time_.add(convert_timer.elapsed());
+                update_depth();
+            } else {
+                rate_repeated_++;
+            }
+
+            if (!emit(video, position)) {
+                break;
+            }
+
+            if (media_state_timer_.elapsed() > 0.1) {
+                media_state_timer_.restart();
+                update_media_state();
+            }
+
+            boost::lock_guard<boost::mutex> lock(state_mutex_);
+            state_["reverse/cache"] = static_cast<double>(reverse.memory_usage()) / (1024.0 * 1024.0);
+        }
+
+        buffer_eof_ = false;
+        tick_base_  = -1;
+        source_     = Source{};
+    }
+
+    // Emits the ticks the last scheduled frame still owns, at the end of the stream
+    void flush_source()
+    {
+        while (source_.frame && tick_time(tick_) < source_.running_time + source_.duration) {
+            if (!emit(source_.frame, source_.position(tick_time(tick_)))) {
+                break;
+            }
+        }
+    }
+
+    // Blends 'alpha' of frame b over frame a
+    static core::draw_frame mix(const core::draw_frame& a, const core::draw_frame& b, double alpha)
+    {
+        if (alpha < 1.0 / 256.0) {
+            return a;
+        }
+        auto next                                = b;
+        next.transform().image_transform.opacity = alpha;
+        return core::draw_frame::over(a, std::move(next));
+    }
+
+    // Audio that plays during the next tick, empty when nothing was ever buffered
+    array<std::int32_t> tick_audio()
+    {
+        // The cadence is per channel frame, interlaced formats take a frame per field. An odd entry
+        // gives its extra sample to the first field so none is lost.
+        const auto fields  = format_desc_.field_count;
+        const auto cadence = audio_cadence_[(frame_count_ / fields) % audio_cadence_.size()];
+        const auto samples = cadence / fields + (frame_count_ % fields < cadence % fields ? 1 : 0);
+        const auto at      = tick_time(tick_);
+        wait_for_audio(at + samples * static_cast<int64_t>(GST_SECOND) / format_desc_.audio_sample_rate);
+
+        if (audio_.end_pts() < 0) {
+            return {};
+        }
+        return audio_.take(at, samples);
+    }
+
+    // Queues a freshly converted frame for the next tick. It carries the audio of that tick itself,
+    // so frames shown once cost no extra frame. 'repeat' is set to the frame muted, for the ticks
+    // it is repeated on.
+    bool emit_first(core::mutable_frame video, int64_t position, core::draw_frame& repeat)
+    {
+        video.audio_data() = tick_audio();
+
+        auto frame                                = core::draw_frame(std::move(video));
+        repeat                                    = frame;
+        repeat.transform().audio_transform.volume = 0.0;
+        return push(std::move(frame), position);
+    }
+
+    // Queues the video for the next tick with the audio that plays during it. The video may be
+    // shown on several ticks, so the audio travels in a frame of its own, unless it is silence.
+    bool emit(core::draw_frame video, int64_t position)
+    {
+        auto audio_data = tick_audio();
+        if (audio_data.empty()) {
+            return push(std::move(video), position);
+        }
+
+        auto audio         = frame_factory_->create_frame(this, core::pixel_format_desc(core::pixel_format::invalid));
+        audio.audio_data() = std::move(audio_data);
+        return push(core::draw_frame::over(std::move(video), core::draw_frame(std::move(audio))), position);
+    }
+
+    // Queues the frame for the next tick, waiting for the render thread to make room. Returns
+    // false when a seek cancelled it.
+    bool push(core::draw_frame video, int64_t position)
+    {
+        Frame frame;
+        frame.frame       = std::move(video);
+        frame.pts         = ns_to_frames(position);
+        frame.duration    = 1;
+        frame.frame_count = frame_count_++;
+        frame.epoch       = frame_epoch_;
+        frame.entry       = frame_entry_;
+        tick_++;
+
+        // Add to buffer, waiting for the render thread to make room
+        {
+            boost::unique_lock<boost::mutex> buffer_lock(buffer_mutex_);
+            while (buffer_.size() >= static_cast<std::size_t>(buffer_depth_) && seek_ == -1) {
+                // The render thread notifies without taking the lock, so never wait
+                // longer than a frame in case that notification is missed
+                buffer_waiting_ = true;
+                buffer_cond_.wait_for(buffer_lock, boost::chrono::milliseconds(static_cast<int>(1000 / format_desc_.fps) + 1));
+            }
+            buffer_waiting_ = false;
+        }
+
+        if (seek_ != -1) {
+            return false;
+        }
+        buffer_.try_push(std::move(frame));
+
+        if (outage_) {
+            outage_    = false;
+            outage_ms_ = elapsed_ms(outage_timer_);
+            CASPAR_LOG(info) << print() << " Network input back after " << outage_ms_ << " ms";
+        }
+
+        if (open_first_frame_ms_ < 0) {
+            open_first_frame_ms_ = elapsed_ms(open_timer_);
+            CASPAR_LOG(debug) << print() << " Ready after " << open_first_frame_ms_ << " ms (pipeline "
+                              << open_pipeline_ms_ << " ms, preroll " << open_preroll_ms_ << " ms)";
+        }
+
+        graph_->set_value("buffer", static_cast<double>(buffer_.size()) / static_cast<double>(buffer_depth_));
+        graph_->set_value("frame-time", frame_timer_.elapsed() * format_desc_.fps * 0.5);
+        frame_timer_.restart();
+
+        if (seek_pending_) {
+            seek_pending_ = false;
+            report_seek();
+        }
+
+        if (input_->live()) {
+            report_live();
+        }
+        return true;
+    }
+
+    // Channel ticks are frames, or fields for interlaced formats
+    int64_t ticks_to_ns(int64_t ticks) const
+    {
+        return static_cast<int64_t>(gst_util_uint64_scale(std::max<int64_t>(ticks, 0),
+                                                          GST_SECOND * format_desc_.framerate.denominator(),
+                                                          format_desc_.framerate.numerator() * format_desc_.field_count));
+    }
+
+    int64_t tick_time(int64_t tick) const { return tick_base_ + ticks_to_ns(tick); }
+
+    int64_t ns_to_frames(int64_t ns) const
+    {
+        return static_cast<int64_t>(gst_util_uint64_scale(std::max<int64_t>(ns, 0),
+                                                          format_desc_.framerate.numerator(),
+                                                          GST_SECOND * format_desc_.framerate.denominator()));
+    }
+
+    // Field order of frames that can pass through an interlaced channel as they are. Anything
+    // the mixer has to scale vertically would mix the fields and is treated as progressive.
+    field_order native_fields(GstSample* sample) const
+    {
+        GstVideoInfo info;
+        if (format_desc_.field_count != 2 || !gst_video_info_from_caps(&info, gst_sample_get_caps(sample)) ||
+            GST_VIDEO_INFO_HEIGHT(&info) != format_desc_.height) {
+            return field_order::progressive;
+        }
+        return buffer_field_order(info, gst_sample_get_buffer(sample));
+    }
+
+    // Pooled inputs are filtered and sized for a channel format, they only fit the same setup.
+    // Local files are identified by modification time and size as well, like in the probe cache,
+    // so a clip replaced under the same name is never served from a pipeline of the old one.
+    std::string pool_key() const
+    {
+        std::string file;
+        boost::system::error_code ec;
+        if (boost::filesystem::is_regular_file(path_, ec)) {
+            const auto mtime = boost::filesystem::last_write_time(path_, ec);
+            const auto size  = boost::filesystem::file_size(path_, ec);
+            if (!ec) {
+                file = std::to_string(mtime) + "|" + std::to_string(size);
+            }
+        }
+        return path_ + "|" + file + "|" + u8(format_desc_.name) + "|" + std::to_string(static_cast<int>(scale_mode_)) + "|" +
+               scaler_ + "|" + vfilter_ + "|" + (policy_ ? policy_->name : std::string());
+    }
+
+    core::mutable_frame convert(GstSample* sample)
+    {
+        auto frame       = make_frame(this, *frame_factory_, sample);
+        frame.geometry() = core::frame_geometry::get_default(scale_mode_);
+        return frame;
+    }
+
+    // Positions from AMCP are channel frames, GStreamer works in stream time nanoseconds
+    int64_t frames_to_ns(int64_t frames) const
+    {
+        return static_cast<int64_t>(gst_util_uint64_scale(std::max<int64_t>(frames, 0),
+                                                          GST_SECOND * format_desc_.framerate.denominator(),
+                                                          format_desc_.framerate.numerator()));
+    }
+
+    // End of the play range in stream time, max when playing to the end of the file
+    int64_t end_ns() const
+    {
+        const auto duration = duration_.load();
+        return duration != std::numeric_limits<int64_t>::max() ? frames_to_ns(start_ + duration)
+                                                                : std::numeric_limits<int64_t>::max();
+    }
+
+    // Hands loop and in/out to the input, which applies them from its next seek
+    void update_range()
+    {
+        if (!opened_) {
+            return;
+        }
+
+        const auto end = end_ns();
+        input_->loop(loop_);
+        input_->range(frames_to_ns(start_) / static_cast<int64_t>(GST_MSECOND),
+                     end != std::numeric_limits<int64_t>::max() ? end / static_cast<int64_t>(GST_MSECOND) : -1);
+    }
+
+    void seek_to(int64_t position)
+    {
+        const auto target = frames_to_ns(position);
+
+        // When the target is ahead in the GOP being decoded right now, decoding on to it is
+        // cheaper than any seek. Only trusted when the index has every keyframe up to the target,
+        // never more than a second ahead and never across a rate change.
+        const auto keyframe = input_->keyframe_before(target);
+        const auto rate     = input_->rate();
+        auto       discard  = true;
+        if (rate < 0.0 && -rate <= config().trickmode_threshold && !input_->live()) {
+            // Every frame is shown going backwards, run_reverse() decodes them GOP by GOP
+            seek_mode_    = "reverse";
+            reverse_from_ = target;
+            last_pts_     = -1;
+            discard       = false;
+            audio_.clear();
+        } else if (rate == 1.0 && seek_rate_ == 1.0 && last_pts_ >= 0 && target > last_pts_ && keyframe >= 0 &&
+            keyframe <= last_pts_ && target - last_pts_ <= static_cast<int64_t>(GST_SECOND) &&
+            input_->indexed(last_pts_, target)) {
+            seek_mode_ = "decode";
+        } else {
+            const auto mode = input_->seek(target / static_cast<int64_t>(GST_MSECOND));
+            seek_rate_      = rate;
+            audio_.clear();
+
+            switch (mode) {
+                case GstInput::seek_mode::key_unit:
+                    seek_mode_ = "key-unit";
+                    break;
+                case GstInput::seek_mode::accurate:
+                    seek_mode_ = "accurate";
+                    break;
+                case GstInput::seek_mode::trickmode:
+                    // Starts at the keyframe before the target, there is nothing to discard
+                    seek_mode_ = "trickmode";
+                    discard    = false;
+                    break;
+            }
+        }
+
+        // The first frame at the target starts a new tick timeline
+        tick_base_ = -1;
+        source_    = Source{};
+
+        seek_target_    = discard ? target : -1;
+        seek_discarded_ = 0;
+        seek_pending_   = true;
+        seek_timer_.restart();
+    }
+
+    // Picks how many frames to decode ahead. The depth covers the conversion time plus three
+    // standard deviations of conversion and arrival jitter, so a source has to stall far beyond
+    // its usual variation before the render thread runs dry. Underflows raise a floor under that
+    // which drops by a frame for every ten seconds without one.
+    void update_depth()
+    {
+        if (const auto underflows = underflows_.exchange(0)) {
+            depth_floor_ = std::min(depth_floor_ + underflows, buffer_max_);
+            depth_timer_.restart();
+        } else if (depth_floor_ > 0 && depth_timer_.elapsed() > 10.0) {
+            depth_floor_--;
+            depth_timer_.restart();
+        }
+
+        const auto margin   = convert_time_.mean + 3.0 * (convert_time_.stddev() + arrival_time_.stddev());
+        const auto required = static_cast<int>(std::ceil(margin * format_desc_.fps)) + 1;
+        const auto depth    = clamp_depth(std::max(required, depth_floor_));
+
+        if (depth != buffer_depth_) {
+            buffer_depth_ = depth;
+            input_->queue_depth(depth);
+        }
+
+        boost::lock_guard<boost::mutex> lock(state_mutex_);
+        state_["buffer/depth"]        = depth;
+        state_["buffer/jitter"]       = arrival_time_.stddev() * 1000.0;
+        state_["buffer/convert-time"] = convert_time_.mean * 1000.0;
+    }
+
+    // Live mode never queues more than the target latency, the ring would only add delay
+    int clamp_depth(int depth) const
+    {
+        depth = std::clamp(depth, buffer_min_, buffer_max_);
+        return live_latency_ >= 0 ? std::min(depth, live_latency_) : depth;
+    }
+
+    // End-to-end latency of a live source: the frames queued behind the one just produced plus
+    // what the pipeline itself buffers
+    void report_live()
+    {
+        const auto backlog = static_cast<int>(buffer_.size()) + input_->video_queued();
+        const auto latency = backlog * 1000.0 / format_desc_.fps + input_->latency() / 1000000.0;
+
+        boost::lock_guard<boost::mutex> lock(state_mutex_);
+        state_["live/latency"] = latency;
+        state_["live/target"]  = live_latency_ * 1000.0 / format_desc_.fps;
+        state_["live/dropped"] = live_dropped_;
+    }
+
+    // Time from the seek request to the first frame at the target being queued
+    void report_seek()
+    {
+        const auto latency = seek_timer_.elapsed();
+        graph_->set_value("seek-time", latency * format_desc_.fps * 0.5);
+
+        CASPAR_LOG(debug) << print() << " Seek (" << seek_mode_ << ", " << input_->video_decoder() << ") took "
+                          << static_cast<int>(latency * 1000.0) << " ms, " << seek_discarded_
+                          << " frames discarded";
+
+        boost::lock_guard<boost::mutex> lock(state_mutex_);
+        state_["seek/latency"]   = latency * 1000.0;
+        state_["seek/mode"]      = seek_mode_;
+        state_["seek/discarded"] = seek_discarded_;
+    }
+
+    // Moves everything decoded so far into the audio ring
+    void drain_audio()
+    {
+        GstSample* audio_sample = nullptr;
+        while (input_->try_pop_audio(&audio_sample)) {
+            if (audio_sample) {
+                audio_.push(audio_sample);
+                gst_sample_unref(audio_sample);
+            }
+        }
+    }
+
+    // Audio is decoded on its own streaming thread and can trail the video slightly, give it up
+    // to a frame to cover 'end' (ns) before the frame is sent without it
+    void wait_for_audio(int64_t end)
+    {
+        drain_audio();
+
+        if (input_->audio_channels() == 0) {
+            return;
+        }
+
+        timer audio_timer;
+        while (audio_.end_pts() < end && !input_->eof() && audio_timer.elapsed() < 1.0 / format_desc_.fps) {
+            GstSample* audio_sample = nullptr;
+            if (input_->pop_audio(&audio_sample, std::chrono::milliseconds(5)) && audio_sample) {
+                audio_.push(audio_sample);
+                gst_sample_unref(audio_sample);
             }
         }
     }
@@ -239,6 +1114,66 @@ struct GstProducer::Impl
         state_["file/clip"] = {start() / format_desc_.fps, duration() / format_desc_.fps};
         state_["file/time"] = {time() / format_desc_.fps, file_duration().value_or(0) / format_desc_.fps};
         state_["loop"]      = loop_;
+        state_["speed"]     = speed();
+
+        state_["open/pipeline"]    = open_pipeline_ms_.load();
+        state_["open/preroll"]     = open_preroll_ms_.load();
+        state_["open/first-frame"] = open_first_frame_ms_.load();
+        state_["open/failed"]      = open_failed_.load();
+        if (!opened_) {
+            return;
+        }
+
+        state_["frame/dropped"]          = rate_dropped_.load();
+        state_["frame/repeated"]         = rate_repeated_.load();
+        state_["frame/field-slips"]      = field_slips_.load();
+        if (input_->network()) {
+            state_["network/connected"]  = !outage_;
+            state_["network/reconnects"] = reconnects_.load();
+            state_["network/outage"]     = outage_ms_.load();
+        }
+    }
+
+    // State that takes locks or builds strings to read, kept off the render thread. Refreshed by
+    // the producer thread every 100 ms and by the commands that change it.
+    void update_media_state()
+    {
+        if (!opened_) {
+            return;
+        }
+
+        const auto playlist = input_->playlist();
+
+        boost::lock_guard<boost::mutex> lock(state_mutex_);
+        const auto video_format = gst_video_format_to_string(input_->video_format());
+        state_["file/video/format"]      = std::string(video_format ? video_format : "");
+        state_["file/video/codec"]       = input_->video_decoder();
+        state_["file/cached"]            = input_->cached();
+
+        if (!playlist.empty()) {
+            const auto index         = on_air_entry_.load();
+            state_["playlist/index"] = index;
+            state_["playlist/size"]  = static_cast<int>(playlist.size());
+            state_["playlist/file"]  = index < static_cast<int>(playlist.size()) ? playlist[index] : std::string();
+        }
+        state_["file/video/fields"]      = field_order_ == field_order::top_first      ? std::string("tff")
+                                           : field_order_ == field_order::bottom_first ? std::string("bff")
+                                                                                       : std::string("progressive");
+        if (policy_) {
+            state_["policy/applied"] = policy_applied_.load();
+        }
+        state_["threads/budget"]         = task_pool::budget();
+        state_["threads/streaming"]      = task_pool::busy_threads();
+        state_["threads/idle"]           = task_pool::idle_threads();
+        state_["teardown/pending"]       = teardown::pending();
+        if (srt_timer_.elapsed() > 1.0) {
+            srt_timer_.restart();
+            if (auto stats = input_->srt_stats()) {
+                srt::publish(*stats, state_);
+            }
+        }
+        state_["file/video/conversion"]  = input_->video_conversion();
+        state_["file/video/conversions"] = input_->video_conversions();
     }
 
     core::draw_frame prev_frame(const core::video_field field)
@@ -248,13 +1183,13 @@ struct GstProducer::Impl
         // Don't start a new frame on the 2nd field
         if (field != core::video_field::b) {
             if (frame_flush_ || !frame_) {
-                boost::lock_guard<boost::mutex> lock(buffer_mutex_);
-
-                if (!buffer_.empty()) {
-                    frame_          = buffer_[0].frame;
-                    frame_time_     = buffer_[0].pts;
-                    frame_duration_ = buffer_[0].duration;
+                if (auto next = front()) {
+                    frame_          = next->frame;
+                    frame_time_     = next->pts;
+                    on_air_entry_   = next->entry;
+                    frame_duration_ = next->duration;
                     frame_flush_    = false;
+                    has_frame_      = true;
                 }
             }
         }
@@ -262,45 +1197,97 @@ struct GstProducer::Impl
         return core::draw_frame::still(frame_);
     }
 
+    // A failed open doesn't hold the layer back, it plays nothing like an empty clip. Neither does
+    // a network input that is down.
     bool is_ready()
     {
-        boost::lock_guard<boost::mutex> lock(buffer_mutex_);
-        return !buffer_.empty() || frame_;
+        return !buffer_.empty() || has_frame_ || open_failed_ || outage_;
+    }
+
+    // Render thread only: skips frames queued before the last seek and peeks at the next one
+    Frame* front()
+    {
+        const auto epoch = epoch_.load();
+
+        Frame* next = buffer_.front();
+        while (next && next->epoch != epoch) {
+            pop();
+            next = buffer_.front();
+        }
+        return next;
+    }
+
+    Frame pop()
+    {
+        Frame frame;
+        buffer_.try_pop(frame);
+
+        if (buffer_waiting_) {
+            buffer_cond_.notify_one();
+        }
+        return frame;
     }
 
     core::draw_frame next_frame(const core::video_field field)
     {
         CASPAR_SCOPE_EXIT { update_state(); };
 
-        boost::lock_guard<boost::mutex> lock(buffer_mutex_);
+        if (!opened_) {
+            return core::draw_frame{};
+        }
+
+        // The first take returns the prerolled frame right away and starts the pipeline
+        const bool first = !playing_.exchange(true);
+        if (first) {
+            executor_.begin_invoke([input = input_] { input->start(); });
+        }
 
-        if (buffer_.empty() || (frame_flush_ && buffer_.size() < 4)) {
+        auto next = front();
+
+        if (!next || (frame_flush_ && buffer_.size() < std::min<std::size_t>(4, buffer_depth_) && !first)) {
             auto start    = start_.load();
             auto duration = duration_.load();
 
             auto end = (duration != std::numeric_limits<int64_t>::max()) ? start + duration : INT64_MAX;
 
+            // The last frame stays on air while a network input reconnects
+            if (outage_) {
+                return core::draw_frame::still(frame_);
+            }
+
             if (buffer_eof_ && !frame_flush_) {
+                // The clip ends just past its last frame
                 if (frame_time_ < end && frame_duration_ != 0) {
-                    frame_time_ += frame_duration_;
-                } else if (frame_time_ < end) {
-                    frame_time_ = input_duration_;
+                    frame_time_     = std::min(end, frame_time_ + frame_duration_);
+                    frame_duration_ = 0;
                 }
                 return core::draw_frame::still(frame_);
             }
             
             graph_->set_tag(diagnostics::tag_severity::WARNING, "underflow");
             latency_ += 1;
+            // Refills after seeks and the start are expected, only starving playback counts
+            if (!frame_flush_) {
+                underflows_++;
+            }
             return core::draw_frame{};
         }
 
         if (format_desc_.field_count == 2) {
-            // Check if the next frame is the correct 'field'
-            auto is_field_1 = (buffer_[0].frame_count % 2) == 0;
-            if ((field == core::video_field::a && !is_field_1) || (field == core::video_field::b && is_field_1)) {
-                graph_->set_tag(diagnostics::tag_severity::WARNING, "underflow");
-                latency_ += 1;
-                return core::draw_frame{};
+            // Frames are queued for alternating fields. Out of phase, the first field skips a
+            // frame queued for a second field and the second field repeats the first, so the
+            // field order holds without leaving a hole.
+            const auto is_field_1 = (next->frame_count % 2) == 0;
+            if (field == core::video_field::a && !is_field_1) {
+                field_slips_++;
+                pop();
+                next = front();
+                if (!next) {
+                    return core::draw_frame::still(frame_);
+                }
+            } else if (field == core::video_field::b && is_field_1) {
+                field_slips_++;
+                return core::draw_frame::still(frame_);
             }
         }
 
@@ -309,23 +1296,16 @@ struct GstProducer::Impl
             latency_ = -1;
         }
 
-        frame_          = buffer_[0].frame;
-        frame_time_     = buffer_[0].pts;
-        frame_duration_ = buffer_[0].duration;
-        frame_flush_    = false;
-        
-        // Free GStreamer memory if needed
-        if (buffer_[0].video) {
-            gst_sample_unref(buffer_[0].video);
-        }
-        if (buffer_[0].audio) {
-            gst_sample_unref(buffer_[0].audio);
-        }
+        auto current = pop();
 
-        buffer_.pop_front();
-        buffer_cond_.notify_all();
+        frame_          = std::move(current.frame);
+        frame_time_     = current.pts;
+        on_air_entry_   = current.entry;
+        frame_duration_ = current.duration;
+        frame_flush_    = false;
+        has_frame_      = true;
 
-        graph_->set_value("buffer", static_cast<double>(buffer_.size()) / static_cast<double>(buffer_capacity_));
+        graph_->set_value("buffer", static_cast<double>(buffer_.size()) / static_cast<double>(buffer_depth_));
 
         return frame_;
     }
@@ -334,30 +1314,38 @@ struct GstProducer::Impl
     {
         CASPAR_SCOPE_EXIT { update_state(); };
 
+        // Everything already queued is stale, the render thread drops it by epoch
+        epoch_++;
         seek_ = time;
+        if (opened_) {
+            input_->wake();
+        }
+        buffer_cond_.notify_all();
+    }
+
+    int64_t time() const
+    {
+        return frame_time_;
+    }
 
+    // Restarts playback at the shown frame with the new rate
+    void speed(double rate)
+    {
         {
-            boost::lock_guard<boost::mutex> lock(buffer_mutex_);
-            buffer_.clear();
-            
-            // Free GStreamer memory
-            for (auto& frame : buffer_) {
-                if (frame.video) {
-                    gst_sample_unref(frame.video);
-                }
-                if (frame.audio) {
-                    gst_sample_unref(frame.audio);
-                }
+            boost::lock_guard<boost::mutex> lock(open_mutex_);
+            if (!opened_) {
+                pending_rate_ = rate;
+                return;
             }
-            
-            buffer_cond_.notify_all();
-            graph_->set_value("buffer", static_cast<double>(buffer_.size()) / static_cast<double>(buffer_capacity_));
         }
+        input_->rate(rate);
+        seek(time());
     }
 
-    int64_t time() const
+    double speed() const
     {
-        return frame_time_;
+        boost::lock_guard<boost::mutex> lock(open_mutex_);
+        return opened_ ? input_->rate() : pending_rate_.value_or(1.0);
     }
 
     void loop(bool loop)
@@ -365,6 +1353,10 @@ struct GstProducer::Impl
         CASPAR_SCOPE_EXIT { update_state(); };
 
         loop_ = loop;
+        update_range();
+        if (opened_) {
+            input_->wake();
+        }
     }
 
     bool loop() const { return loop_; }
@@ -373,6 +1365,10 @@ struct GstProducer::Impl
     {
         CASPAR_SCOPE_EXIT { update_state(); };
         start_ = start;
+        update_range();
+        if (opened_) {
+            input_->wake();
+        }
     }
 
     int64_t start() const
@@ -385,6 +1381,10 @@ struct GstProducer::Impl
         CASPAR_SCOPE_EXIT { update_state(); };
 
         duration_ = duration;
+        update_range();
+        if (opened_) {
+            input_->wake();
+        }
     }
 
     int64_t duration() const
@@ -393,13 +1393,56 @@ struct GstProducer::Impl
         return duration != std::numeric_limits<int64_t>::max() ? duration : 0;
     }
 
+    void playlist_append(std::string path)
+    {
+        CASPAR_SCOPE_EXIT { update_media_state(); };
+        {
+            boost::lock_guard<boost::mutex> lock(open_mutex_);
+            if (!opened_) {
+                pending_playlist_.push_back(std::move(path));
+                return;
+            }
+        }
+        input_->playlist_append(path);
+    }
+
+    bool playlist_remove(int index)
+    {
+        CASPAR_SCOPE_EXIT { update_media_state(); };
+        {
+            boost::lock_guard<boost::mutex> lock(open_mutex_);
+            if (!opened_) {
+                if (index < 0 || index >= static_cast<int>(pending_playlist_.size())) {
+                    return false;
+                }
+                pending_playlist_.erase(pending_playlist_.begin() + index);
+                return true;
+            }
+        }
+        return index >= 0 && input_->playlist_remove(static_cast<std::size_t>(index));
+    }
+
+    std::vector<std::string> playlist() const
+    {
+        boost::lock_guard<boost::mutex> lock(open_mutex_);
+        return opened_ ? input_->playlist() : pending_playlist_;
+    }
+
+    int playlist_index() const { return on_air_entry_; }
+
     std::optional<int64_t> file_duration() const
     {
-        const auto input_duration = input_.duration();
+        if (!opened_) {
+            return {};
+        }
+        const auto input_duration = input_->duration();
         if (input_duration == 0) {
             return {};
         }
-        return input_duration;
+        // The input reports milliseconds, everything here is in channel frames
+        return static_cast<int64_t>(gst_util_uint64_scale(input_duration,
+                                                          format_desc_.framerate.numerator(),
+                                                          format_desc_.framerate.denominator() * 1000));
     }
 
     std::string print() const
@@ -422,7 +1465,12 @@ GstProducer::GstProducer(std::shared_ptr<core::frame_factory> frame_factory,
                        std::optional<int64_t>               seek,
                        std::optional<int64_t>               duration,
                        std::optional<bool>                  loop,
-                       core::frame_geometry::scale_mode     scale_mode)
+                       core::frame_geometry::scale_mode     scale_mode,
+                       std::vector<std::string>             playlist,
+                       std::optional<int>                   live,
+                       bool                                 blend,
+                       std::string                          scaler,
+                       std::optional<thread_policy>         policy)
     : impl_(new Impl(std::move(frame_factory),
                      std::move(format_desc),
                      std::move(name),
@@ -432,7 +1480,12 @@ GstProducer::GstProducer(std::shared_ptr<core::frame_factory> frame_factory,
                      std::move(seek),
                      std::move(duration),
                      std::move(loop),
-                     scale_mode))
+                     scale_mode,
+                     std::move(playlist),
+                     live,
+                     blend,
+                     std::move(scaler),
+                     std::move(policy)))
 {
 }
 
@@ -464,6 +1517,14 @@ GstProducer& GstProducer::start(int64_t start)
 
 int64_t GstProducer::time() const { return impl_->time(); }
 
+GstProducer& GstProducer::speed(double rate)
+{
+    impl_->speed(rate);
+    return *this;
+}
+
+double GstProducer::speed() const { return impl_->speed(); }
+
 int64_t GstProducer::start() const { return impl_->start(); }
 
 GstProducer& GstProducer::duration(int64_t duration)
@@ -474,6 +1535,18 @@ GstProducer& GstProducer::duration(int64_t duration)
 
 int64_t GstProducer::duration() const { return impl_->duration(); }
 
+GstProducer& GstProducer::playlist_append(std::string path)
+{
+    impl_->playlist_append(std::move(path));
+    return *this;
+}
+
+bool GstProducer::playlist_remove(int index) { return impl_->playlist_remove(index); }
+
+std::vector<std::string> GstProducer::playlist() const { return impl_->playlist(); }
+
+int GstProducer::playlist_index() const { return impl_->playlist_index(); }
+
 core::monitor::state GstProducer::state() const
 {
     boost::lock_guard<boost::mutex> lock(impl_->state_mutex_);
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <core/frame/draw_frame.h>
 #include <core/frame/frame_factory.h>
@@ -8,6 +10,8 @@
 #include <core/monitor/monitor.h>
 #include <core/video_format.h>
 
+#include "../util/gst_config.h"
+
 namespace caspar { namespace gstreamer {
 
 class GstProducer
@@ -22,7 +26,12 @@ public:
                 std::optional<int64_t>               seek,
                 std::optional<int64_t>               duration,
                 std::optional<bool>                  loop,
-                core::frame_geometry::scale_mode     scale_mode);
+                core::frame_geometry::scale_mode     scale_mode,
+                std::vector<std::string>             playlist = {},
+                std::optional<int>                   live     = {},
+                bool                                 blend    = false,
+                std::string                          scaler   = {},
+                std::optional<thread_policy>         policy   = {});
 
     core::draw_frame prev_frame(const core::video_field field);
     core::draw_frame next_frame(const core::video_field field);
@@ -31,6 +40,10 @@ public:
     GstProducer& seek(int64_t time);
     int64_t     time() const;
 
+    // Playback rate, negative plays in reverse
+    GstProducer& speed(double rate);
+    double       speed() const;
+
     GstProducer& loop(bool loop);
     bool        loop() const;
 
@@ -40,6 +53,12 @@ public:
     GstProducer& duration(int64_t duration);
     int64_t     duration() const;
 
+    // Playlist mode, entries are resolved paths or URIs
+    GstProducer&             playlist_append(std::string path);
+    bool                     playlist_remove(int index);
+    std::vector<std::string> playlist() const;
+    int                      playlist_index() const;
+
     caspar::core::monitor::state state() const;
 
 private:
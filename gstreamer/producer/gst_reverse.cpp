@@ -0,0 +1,144 @@
+#include "gst_reverse.h"
+
+#include <common/log.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace caspar { namespace gstreamer {
+
+GstReverse::GstReverse(std::shared_ptr<GstInput> input, int64_t from, int64_t start, std::size_t budget)
+    : input_(std::move(input))
+    , start_(std::max<int64_t>(start, 0))
+    , budget_(std::max<std::size_t>(budget / 2, 1))
+{
+    // The first chunk ends just past the frame shown at 'from'
+    current_.from = from + 1;
+    prefetch();
+}
+
+GstReverse::~GstReverse()
+{
+    abort_ = true;
+    input_->wake();
+
+    if (next_.valid()) {
+        try {
+            next_.get();
+        } catch (...) {
+            CASPAR_LOG_CURRENT_EXCEPTION();
+        }
+    }
+}
+
+GstReverse::status GstReverse::frame_at(int64_t position, gst_ptr<GstSample>& sample)
+{
+    if (position < start_) {
+        return status::end;
+    }
+
+    while (true) {
+        // Everything after the position has been shown
+        while (!current_.samples.empty() && pts(current_.samples.back()) > position) {
+            pop_back(current_);
+        }
+
+        if (!current_.samples.empty()) {
+            sample = current_.samples.back();
+            return status::frame;
+        }
+
+        if (!next_.valid()) {
+            return status::end;
+        }
+        if (next_.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready) {
+            return status::pending;
+        }
+
+        current_ = next_.get();
+        prefetch();
+    }
+}
+
+void GstReverse::prefetch()
+{
+    const auto end = current_.from;
+    if (end <= start_ || end <= 0) {
+        return;
+    }
+    next_ = executor_.begin_invoke([this, end] { return decode(end); });
+}
+
+GstReverse::chunk GstReverse::decode(int64_t end)
+{
+    chunk result;
+
+    input_->seek_before(end);
+
+    while (!abort_ && !input_->has_error()) {
+        // Audio isn't played backwards, don't let it block the demuxer
+        GstSample* audio = nullptr;
+        while (input_->try_pop_audio(&audio)) {
+            if (audio) {
+                gst_sample_unref(audio);
+            }
+        }
+
+        GstSample* video = nullptr;
+        if (input_->pop_video(&video, std::chrono::milliseconds(20))) {
+            if (!video) {
+                continue;
+            }
+
+            auto       sample    = make_gst_ptr<GstSample>(video);
+            const auto timestamp = pts(sample);
+            if (timestamp < 0 || timestamp >= end) {
+                continue;
+            }
+
+            // Over budget the oldest frames go, the next chunk decodes up to the first one kept
+            result.memory += size(sample);
+            result.samples.push_back(std::move(sample));
+            while (result.memory > budget_ && result.samples.size() > 1) {
+                result.memory -= size(result.samples.front());
+                result.samples.pop_front();
+            }
+        } else if (input_->eof()) {
+            break;
+        }
+    }
+
+    if (!result.samples.empty()) {
+        result.from = pts(result.samples.front());
+    } else {
+        // Nothing before 'end' came out, e.g. a GOP without timestamps or an error. Step back past
+        // the keyframe it was decoded from, or a second when that isn't known, instead of ending.
+        const auto keyframe = input_->keyframe_before(end - 1);
+        result.from         = keyframe >= 0 ? keyframe : std::max<int64_t>(end - static_cast<int64_t>(GST_SECOND), 0);
+    }
+    memory_ += result.memory;
+
+    return result;
+}
+
+void GstReverse::pop_back(chunk& chunk)
+{
+    const auto memory = size(chunk.samples.back());
+    chunk.memory -= memory;
+    memory_ -= memory;
+    chunk.samples.pop_back();
+}
+
+int64_t GstReverse::pts(const gst_ptr<GstSample>& sample)
+{
+    GstBuffer* buffer = gst_sample_get_buffer(sample.get());
+    return buffer && GST_BUFFER_PTS_IS_VALID(buffer) ? static_cast<int64_t>(GST_BUFFER_PTS(buffer)) : -1;
+}
+
+std::size_t GstReverse::size(const gst_ptr<GstSample>& sample)
+{
+    GstBuffer* buffer = gst_sample_get_buffer(sample.get());
+    return buffer ? gst_buffer_get_size(buffer) : 0;
+}
+
+}} // namespace caspar::gstreamer
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "gst_input.h"
+
+#include <common/executor.h>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+
+namespace caspar { namespace gstreamer {
+
+// Reverse playback for long-GOP sources. Frames only decode forwards from a keyframe, so the
+// stretch before the play position is decoded forwards into a cache and handed out backwards.
+// While one chunk plays out the one before it is decoded on a worker.
+//
+// A chunk spans at most one GOP and half the memory budget. Longer GOPs are decoded from their
+// keyframe again for each chunk, keeping only the frames the chunk needs. Samples are cached
+// unconverted so frames that are never shown don't pay for conversion. The input is driven by
+// the worker while this exists.
+class GstReverse
+{
+  public:
+    enum class status
+    {
+        frame,   // The sample is set
+        pending, // The chunk holding the position is still being decoded
+        end,     // The position is before the start
+    };
+
+    // Plays backwards from 'from' to 'start', positions are stream time in nanoseconds
+    GstReverse(std::shared_ptr<GstInput> input, int64_t from, int64_t start, std::size_t budget);
+    ~GstReverse();
+
+    // The sample shown at 'position', which must not increase from one call to the next
+    status frame_at(int64_t position, gst_ptr<GstSample>& sample);
+
+    // Memory held by cached samples
+    std::size_t memory_usage() const { return memory_; }
+
+  private:
+    struct chunk
+    {
+        std::deque<gst_ptr<GstSample>> samples; // Ascending timestamps
+        std::size_t                    memory = 0;
+        int64_t                        from   = -1; // Where the next chunk ends, the first sample when there is one
+    };
+
+    chunk decode(int64_t end);
+    void  prefetch();
+    void  pop_back(chunk& chunk);
+
+    static int64_t     pts(const gst_ptr<GstSample>& sample);
+    static std::size_t size(const gst_ptr<GstSample>& sample);
+
+    const std::shared_ptr<GstInput> input_;
+    const int64_t                   start_;
+    const std::size_t               budget_; // Per chunk
+
+    chunk                    current_;
+    std::future<chunk>       next_;
+    std::atomic<bool>        abort_{false};
+    std::atomic<std::size_t> memory_{0};
+    caspar::executor         executor_{L"gstreamer_reverse"};
+};
+
+}} // namespace caspar::gstreamer
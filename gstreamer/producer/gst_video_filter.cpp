@@ -0,0 +1,406 @@
+#include "gst_video_filter.h"
+
+#include "../util/gst_task_pool.h"
+
+#include <common/except.h>
+#include <common/log.h>
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace caspar { namespace gstreamer {
+
+namespace {
+
+// Crops and sizes are kept even for the subsampled chroma planes
+int even(double value) { return std::max(static_cast<int>(value) & ~1, 0); }
+
+// Sets an enum property by nick, false when the element doesn't know the nick
+bool set_enum(GstElement* element, const char* name, const std::string& nick)
+{
+    GParamSpec* spec = g_object_class_find_property(G_OBJECT_GET_CLASS(element), name);
+    if (!spec || !G_IS_PARAM_SPEC_ENUM(spec)) {
+        return false;
+    }
+    GEnumValue* value = g_enum_get_value_by_nick(G_PARAM_SPEC_ENUM(spec)->enum_class, nick.c_str());
+    if (!value) {
+        return false;
+    }
+    g_object_set(G_OBJECT(element), name, value->value, NULL);
+    return true;
+}
+
+// Arguments of one FFmpeg filter, "a:b" or "name=a:other=b"
+class filter_args
+{
+  public:
+    explicit filter_args(const std::string& args)
+    {
+        if (args.empty()) {
+            return;
+        }
+        std::vector<std::string> items;
+        boost::split(items, args, boost::is_any_of(":"));
+        for (auto& item : items) {
+            const auto eq = item.find('=');
+            if (eq == std::string::npos) {
+                positional_.push_back(boost::trim_copy(item));
+            } else {
+                named_[boost::trim_copy(item.substr(0, eq))] = boost::trim_copy(item.substr(eq + 1));
+            }
+        }
+    }
+
+    std::string get(std::size_t index, const std::string& name, const std::string& fallback = "") const
+    {
+        const auto it = named_.find(name);
+        if (it != named_.end()) {
+            return it->second;
+        }
+        return index < positional_.size() ? positional_[index] : fallback;
+    }
+
+  private:
+    std::vector<std::string>           positional_;
+    std::map<std::string, std::string> named_;
+};
+
+gst_ptr<GstElement> make_filter_element(const std::string& factory)
+{
+    auto element = make_element(factory);
+    task_pool::apply_budget(element.get());
+    return element;
+}
+
+gst_ptr<GstElement> make_flip(const std::string& method)
+{
+    auto flip = make_filter_element("videoflip");
+    if (!set_enum(flip.get(), "method", method)) {
+        CASPAR_THROW_EXCEPTION(invalid_argument() << msg_info_t("Unknown videoflip method: " + method));
+    }
+    return flip;
+}
+
+// yadif and bwdif map onto deinterlace with the yadif method where available
+gst_ptr<GstElement> make_yadif(const filter_args& args)
+{
+    auto deinterlace = make_filter_element("deinterlace");
+    if (!set_enum(deinterlace.get(), "method", "yadif")) {
+        set_enum(deinterlace.get(), "method", "greedyh");
+    }
+
+    // send_frame keeps the frame rate, send_field doubles it
+    const auto mode = args.get(0, "mode", "0");
+    set_enum(deinterlace.get(), "fields", mode == "1" || mode == "3" || mode == "send_field" ? "all" : "top");
+
+    const auto parity = args.get(1, "parity", "-1");
+    if (parity == "0" || parity == "tff") {
+        set_enum(deinterlace.get(), "tff", "tff");
+    } else if (parity == "1" || parity == "bff") {
+        set_enum(deinterlace.get(), "tff", "bff");
+    }
+
+    // Progressive frames pass through unless all frames are to be deinterlaced
+    const auto deint = args.get(2, "deint", "");
+    if (deint == "0" || deint == "all") {
+        set_enum(deinterlace.get(), "mode", "interlaced");
+    }
+    return deinterlace;
+}
+
+gst_ptr<GstElement> make_deinterlace(const filter_args& args)
+{
+    auto deinterlace = make_filter_element("deinterlace");
+
+    const auto method = args.get(0, "method");
+    if (!method.empty() && !set_enum(deinterlace.get(), "method", method)) {
+        CASPAR_THROW_EXCEPTION(invalid_argument() << msg_info_t("Unknown deinterlace method: " + method));
+    }
+    const auto fields = args.get(1, "fields");
+    if (!fields.empty() && !set_enum(deinterlace.get(), "fields", fields)) {
+        CASPAR_THROW_EXCEPTION(invalid_argument() << msg_info_t("Unknown deinterlace fields: " + fields));
+    }
+    return deinterlace;
+}
+
+std::string parse_framerate(std::string rate)
+{
+    static const std::map<std::string, std::string> names = {
+        {"pal", "25/1"}, {"ntsc", "30000/1001"}, {"film", "24/1"}, {"ntsc_film", "24000/1001"}};
+
+    boost::to_lower(rate);
+    const auto it = names.find(rate);
+    if (it != names.end()) {
+        return it->second;
+    }
+
+    const auto slash = rate.find('/');
+    const auto num   = std::stoi(rate.substr(0, slash));
+    const auto den   = slash == std::string::npos ? 1 : std::stoi(rate.substr(slash + 1));
+    if (num <= 0 || den <= 0) {
+        CASPAR_THROW_EXCEPTION(invalid_argument() << msg_info_t("Invalid frame rate: " + rate));
+    }
+    return std::to_string(num) + "/" + std::to_string(den);
+}
+
+} // namespace
+
+GstScaleFilter::GstScaleFilter(const core::video_format_desc&   format_desc,
+                               core::frame_geometry::scale_mode scale_mode,
+                               const std::string&               method)
+    : width_(format_desc.width)
+    , height_(format_desc.height)
+    , aspect_(static_cast<double>(format_desc.square_width) / static_cast<double>(format_desc.square_height))
+    , scale_mode_(scale_mode)
+    , crop_(make_element("videocrop", "video_crop"))
+    , scale_(make_element("videoscale", "video_scale"))
+    , filter_(make_element("capsfilter", "video_size"))
+{
+    if (!method.empty()) {
+        gst_util_set_object_arg(G_OBJECT(scale_.get()), "method", method.c_str());
+    }
+    task_pool::apply_budget(scale_.get());
+
+    GstPad* pad = gst_element_get_static_pad(crop_.get(), "sink");
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, &GstScaleFilter::caps_probe, this, nullptr);
+    gst_object_unref(pad);
+}
+
+std::vector<GstElement*> GstScaleFilter::elements() const { return {crop_.get(), scale_.get(), filter_.get()}; }
+
+GstPadProbeReturn GstScaleFilter::caps_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    GstEvent* event = GST_PAD_PROBE_INFO_EVENT(info);
+    if (GST_EVENT_TYPE(event) == GST_EVENT_CAPS) {
+        GstCaps* caps = nullptr;
+        gst_event_parse_caps(event, &caps);
+        static_cast<GstScaleFilter*>(user_data)->update(caps);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+void GstScaleFilter::update(GstCaps* caps)
+{
+    GstVideoInfo info;
+    if (!caps || !gst_video_info_from_caps(&info, caps)) {
+        return;
+    }
+
+    const int width  = GST_VIDEO_INFO_WIDTH(&info);
+    const int height = GST_VIDEO_INFO_HEIGHT(&info);
+
+    int crop_x = 0;
+    int crop_y = 0;
+    int out_w  = width;
+    int out_h  = height;
+
+    // Scaling fields together would mix them, interlaced video is left to the mixer
+    if (scale_mode_ != core::frame_geometry::scale_mode::original && GST_VIDEO_INFO_IS_INTERLACED(&info) == FALSE &&
+        width > 0 && height > 0) {
+        // Display aspect of the source relative to the channel, > 1 when the source is wider
+        const double par   = static_cast<double>(GST_VIDEO_INFO_PAR_N(&info)) / GST_VIDEO_INFO_PAR_D(&info);
+        const double ratio = static_cast<double>(width) * par / static_cast<double>(height) / aspect_;
+
+        auto fit = [&] {
+            out_w = ratio > 1.0 ? width_ : even(width_ * ratio);
+            out_h = ratio > 1.0 ? even(height_ / ratio) : height_;
+        };
+        auto fill = [&] {
+            crop_x = ratio > 1.0 ? even((width - width / ratio) / 2.0) : 0;
+            crop_y = ratio > 1.0 ? 0 : even((height - height * ratio) / 2.0);
+            out_w  = width_;
+            out_h  = height_;
+        };
+
+        switch (scale_mode_) {
+            case core::frame_geometry::scale_mode::fit:
+                fit();
+                break;
+            case core::frame_geometry::scale_mode::fill:
+                fill();
+                break;
+            case core::frame_geometry::scale_mode::hfill:
+                ratio > 1.0 ? fit() : fill();
+                break;
+            case core::frame_geometry::scale_mode::vfill:
+                ratio > 1.0 ? fill() : fit();
+                break;
+            default:
+                out_w = width_;
+                out_h = height_;
+                break;
+        }
+
+        // Only ever reduce the pixel count here, the mixer scales up for free
+        const int cropped_w = width - 2 * crop_x;
+        const int cropped_h = height - 2 * crop_y;
+        if (static_cast<int64_t>(out_w) * out_h >= static_cast<int64_t>(cropped_w) * cropped_h) {
+            out_w = cropped_w;
+            out_h = cropped_h;
+        }
+    }
+
+    g_object_set(G_OBJECT(crop_.get()), "left", crop_x, "right", crop_x, "top", crop_y, "bottom", crop_y, NULL);
+
+    GstCaps* size = gst_caps_new_simple("video/x-raw", "width", G_TYPE_INT, out_w, "height", G_TYPE_INT, out_h, NULL);
+    g_object_set(G_OBJECT(filter_.get()), "caps", size, NULL);
+    gst_caps_unref(size);
+
+    CASPAR_LOG(debug) << "[gstreamer] Scaling " << width << "x" << height << " to " << out_w << "x" << out_h
+                      << " (crop " << crop_x << "," << crop_y << ")";
+}
+
+GstCropFilter::GstCropFilter(int width, int height, int x, int y)
+    : width_(width)
+    , height_(height)
+    , x_(x)
+    , y_(y)
+    , crop_(make_filter_element("videocrop"))
+{
+    if (width_ <= 0 || height_ <= 0) {
+        CASPAR_THROW_EXCEPTION(invalid_argument() << msg_info_t("Invalid crop size"));
+    }
+
+    GstPad* pad = gst_element_get_static_pad(crop_.get(), "sink");
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, &GstCropFilter::caps_probe, this, nullptr);
+    gst_object_unref(pad);
+}
+
+GstPadProbeReturn GstCropFilter::caps_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    GstEvent* event = GST_PAD_PROBE_INFO_EVENT(info);
+    if (GST_EVENT_TYPE(event) == GST_EVENT_CAPS) {
+        GstCaps* caps = nullptr;
+        gst_event_parse_caps(event, &caps);
+        static_cast<GstCropFilter*>(user_data)->update(caps);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+void GstCropFilter::update(GstCaps* caps)
+{
+    GstVideoInfo info;
+    if (!caps || !gst_video_info_from_caps(&info, caps)) {
+        return;
+    }
+
+    const int width  = GST_VIDEO_INFO_WIDTH(&info);
+    const int height = GST_VIDEO_INFO_HEIGHT(&info);
+
+    const int w    = std::max(even(std::min(width_, width)), 2);
+    const int h    = std::max(even(std::min(height_, height)), 2);
+    const int left = even(x_ < 0 ? (width - w) / 2.0 : std::min(x_, width - w));
+    const int top  = even(y_ < 0 ? (height - h) / 2.0 : std::min(y_, height - h));
+
+    g_object_set(G_OBJECT(crop_.get()),
+                 "left",
+                 left,
+                 "right",
+                 std::max(width - w - left, 0),
+                 "top",
+                 top,
+                 "bottom",
+                 std::max(height - h - top, 0),
+                 NULL);
+}
+
+GstFilterChain::GstFilterChain(const std::string&               filter,
+                               const core::video_format_desc&   format_desc,
+                               core::frame_geometry::scale_mode scale_mode,
+                               const std::string&               scaler)
+    : scale_(format_desc, scale_mode, scaler)
+{
+    parse(filter);
+}
+
+std::vector<GstElement*> GstFilterChain::elements() const
+{
+    std::vector<GstElement*> result;
+    for (const auto& element : elements_) {
+        result.push_back(element.get());
+    }
+    for (auto element : scale_.elements()) {
+        result.push_back(element);
+    }
+    return result;
+}
+
+void GstFilterChain::parse(const std::string& filter)
+{
+    std::vector<std::string> entries;
+    boost::split(entries, filter, boost::is_any_of(",;"));
+
+    for (auto entry : entries) {
+        boost::trim(entry);
+        if (entry.empty()) {
+            continue;
+        }
+
+        const auto       eq   = entry.find('=');
+        const auto       name = boost::to_lower_copy(entry.substr(0, eq));
+        const filter_args args(eq == std::string::npos ? "" : entry.substr(eq + 1));
+
+        // Elements of one filter are only added once all of them could be made
+        std::vector<gst_ptr<GstElement>> elements;
+        try {
+            if (name == "yadif" || name == "bwdif") {
+                elements.push_back(make_yadif(args));
+            } else if (name == "deinterlace") {
+                elements.push_back(make_deinterlace(args));
+            } else if (name == "hflip") {
+                elements.push_back(make_flip("horizontal-flip"));
+            } else if (name == "vflip") {
+                elements.push_back(make_flip("vertical-flip"));
+            } else if (name == "transpose") {
+                static const std::map<std::string, std::string> directions = {
+                    {"0", "upper-left-diagonal"},
+                    {"cclock_flip", "upper-left-diagonal"},
+                    {"1", "clockwise"},
+                    {"clock", "clockwise"},
+                    {"2", "counterclockwise"},
+                    {"cclock", "counterclockwise"},
+                    {"3", "upper-right-diagonal"},
+                    {"clock_flip", "upper-right-diagonal"}};
+                const auto it = directions.find(args.get(0, "dir", "0"));
+                if (it == directions.end()) {
+                    CASPAR_THROW_EXCEPTION(invalid_argument() << msg_info_t("Invalid transpose direction"));
+                }
+                elements.push_back(make_flip(it->second));
+            } else if (name == "videoflip") {
+                elements.push_back(make_flip(args.get(0, "method", "none")));
+            } else if (name == "crop") {
+                auto crop = std::make_unique<GstCropFilter>(std::stoi(args.get(0, "w")),
+                                                            std::stoi(args.get(1, "h")),
+                                                            std::stoi(args.get(2, "x", "-1")),
+                                                            std::stoi(args.get(3, "y", "-1")));
+                elements.push_back(make_gst_ptr<GstElement>(GST_ELEMENT(gst_object_ref(crop->element()))));
+                crops_.push_back(std::move(crop));
+            } else if (name == "fps" || name == "framerate") {
+                const auto rate = parse_framerate(args.get(0, "fps"));
+                elements.push_back(make_filter_element("videorate"));
+                elements.push_back(make_filter_element("capsfilter"));
+
+                GstCaps* caps = gst_caps_from_string(("video/x-raw,framerate=" + rate).c_str());
+                g_object_set(G_OBJECT(elements.back().get()), "caps", caps, NULL);
+                gst_caps_unref(caps);
+            } else {
+                CASPAR_LOG(warning) << "[gstreamer] Unsupported video filter: " << entry;
+                continue;
+            }
+        } catch (...) {
+            CASPAR_LOG_CURRENT_EXCEPTION();
+            CASPAR_LOG(warning) << "[gstreamer] Skipping video filter: " << entry;
+            continue;
+        }
+
+        for (auto& element : elements) {
+            elements_.push_back(std::move(element));
+        }
+        description_ += (description_.empty() ? "" : ",") + entry;
+    }
+}
+
+}} // namespace caspar::gstreamer
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "../util/gst_util.h"
+
+#include <core/frame/geometry.h>
+#include <core/video_format.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace caspar { namespace gstreamer {
+
+// Crops and downscales decoded video in the sink bin so the mixer never gets more pixels than
+// the channel shows. Crop and size follow from the decoded caps, the channel format and the
+// scale mode, and are worked out again whenever the caps change. Cropping comes first, so
+// cropped pixels are never scaled or converted. Upscaling is left to the mixer GPU.
+class GstScaleFilter
+{
+  public:
+    // 'method' is a videoscale method such as "bilinear" or "lanczos", empty for the default
+    GstScaleFilter(const core::video_format_desc&   format_desc,
+                   core::frame_geometry::scale_mode scale_mode,
+                   const std::string&               method);
+
+    // videocrop ! videoscale ! capsfilter, in that order
+    std::vector<GstElement*> elements() const;
+
+  private:
+    static GstPadProbeReturn caps_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    void                     update(GstCaps* caps);
+
+    const int                              width_;
+    const int                              height_;
+    const double                           aspect_; // Display aspect ratio of the channel
+    const core::frame_geometry::scale_mode scale_mode_;
+
+    gst_ptr<GstElement> crop_;
+    gst_ptr<GstElement> scale_;
+    gst_ptr<GstElement> filter_;
+};
+
+// FFmpeg style crop=w:h:x:y. videocrop takes margins, so they are worked out from the decoded
+// size whenever the caps change. A negative x or y centers the crop.
+class GstCropFilter
+{
+  public:
+    GstCropFilter(int width, int height, int x, int y);
+
+    GstElement* element() const { return crop_.get(); }
+
+  private:
+    static GstPadProbeReturn caps_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    void                     update(GstCaps* caps);
+
+    const int width_;
+    const int height_;
+    const int x_;
+    const int y_;
+
+    gst_ptr<GstElement> crop_;
+};
+
+// The video branch of the producer sink bin ahead of videoconvert. The FILTER/VF string is
+// translated from FFmpeg filter syntax into GStreamer elements, which run on the decoded format
+// before anything is converted, followed by the scaling for the channel. Supported filters:
+//
+//   yadif[=mode:parity:deint], bwdif[=mode:parity:deint]
+//   deinterlace[=method:fields]   GStreamer deinterlace methods, e.g. greedyh, linear, vfir
+//   hflip, vflip, transpose[=dir], videoflip=method
+//   crop=w:h[:x:y]
+//   fps=rate                      e.g. 25 or 30000/1001
+//
+// Unknown filters are logged and skipped.
+class GstFilterChain
+{
+  public:
+    GstFilterChain(const std::string&               filter,
+                   const core::video_format_desc&   format_desc,
+                   core::frame_geometry::scale_mode scale_mode,
+                   const std::string&               scaler);
+
+    // In pipeline order
+    std::vector<GstElement*> elements() const;
+
+    // The filters that were applied, in the FILTER syntax
+    const std::string& description() const { return description_; }
+
+  private:
+    void parse(const std::string& filter);
+
+    std::vector<gst_ptr<GstElement>>            elements_;
+    std::vector<std::unique_ptr<GstCropFilter>> crops_;
+    GstScaleFilter                              scale_;
+    std::string                                 description_;
+};
+
+}} // namespace caspar::gstreamer
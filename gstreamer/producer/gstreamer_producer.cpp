@@ -19,6 +19,10 @@
 
 #include "gstreamer_producer.h"
 #include "gst_producer.h"
+#include "../util/gst_config.h"
+#include "../util/gst_srt.h"
+#include "../util/gst_teardown.h"
+#include "../util/gst_thread_policy.h"
  
 #include <common/env.h>
 #include <common/os/filesystem.h>
@@ -35,12 +39,17 @@
 #include <boost/filesystem/fstream.hpp>
 #include <boost/logic/tribool.hpp>
 #include <common/filesystem.h>
+
+#include <optional>
+#include <sstream>
  
 namespace caspar { namespace gstreamer {
+
+static std::optional<std::wstring> resolve_path(const std::wstring& name);
  
 struct gstreamer_producer : public core::frame_producer
 {
-    const std::wstring                   filename_;
+    const std::wstring                   filename_; // Passphrases masked, for logs only
     spl::shared_ptr<core::frame_factory> frame_factory_;
     core::video_format_desc              format_desc_;
  
@@ -56,8 +65,13 @@ struct gstreamer_producer : public core::frame_producer
                               std::optional<int64_t>               seek,
                               std::optional<int64_t>               duration,
                               std::optional<bool>                  loop,
-                              core::frame_geometry::scale_mode     scale_mode)
-        : filename_(filename)
+                              core::frame_geometry::scale_mode     scale_mode,
+                              std::vector<std::wstring>            playlist,
+                              std::optional<int>                   live,
+                              bool                                 blend,
+                              std::wstring                         scaler,
+                              std::optional<thread_policy>         policy)
+        : filename_(u16(srt::redact(u8(filename))))
         , frame_factory_(frame_factory)
         , format_desc_(format_desc)
         , producer_(new GstProducer(frame_factory_,
@@ -69,20 +83,28 @@ struct gstreamer_producer : public core::frame_producer
                                    seek,
                                    duration,
                                    loop,
-                                   scale_mode))
+                                   scale_mode,
+                                   to_u8(playlist),
+                                   live,
+                                   blend,
+                                   u8(scaler),
+                                   std::move(policy)))
     {
-        CASPAR_LOG(info) << L"GStreamer producer created for file: " << filename;
+        CASPAR_LOG(info) << L"GStreamer producer created for file: " << filename_;
     }
  
     ~gstreamer_producer()
     {
-        std::thread([producer = std::move(producer_)]() mutable {
-            try {
-                producer.reset();
-            } catch (...) {
-                CASPAR_LOG_CURRENT_EXCEPTION();
-            }
-        }).detach();
+        teardown::post([producer = std::move(producer_)]() mutable { producer.reset(); });
+    }
+ 
+    static std::vector<std::string> to_u8(const std::vector<std::wstring>& paths)
+    {
+        std::vector<std::string> result;
+        for (const auto& path : paths) {
+            result.push_back(u8(path));
+        }
+        return result;
     }
  
     // frame_producer
@@ -162,6 +184,44 @@ struct gstreamer_producer : public core::frame_producer
             producer_->seek(seek);
  
             result = std::to_wstring(seek);
+        } else if (boost::iequals(cmd, L"speed")) {
+            if (!value.empty()) {
+                const auto rate = boost::lexical_cast<double>(value);
+                if (rate == 0.0) {
+                    CASPAR_THROW_EXCEPTION(invalid_argument());
+                }
+                producer_->speed(rate);
+            }
+ 
+            result = std::to_wstring(producer_->speed());
+        } else if (boost::iequals(cmd, L"playlist")) {
+            if (boost::iequals(value, L"append") && params.size() > 2) {
+                auto path = resolve_path(params.at(2));
+                if (!path) {
+                    CASPAR_THROW_EXCEPTION(invalid_argument());
+                }
+                producer_->playlist_append(u8(*path));
+ 
+                result = std::to_wstring(producer_->playlist().size());
+            } else if (boost::iequals(value, L"remove") && params.size() > 2) {
+                if (!producer_->playlist_remove(boost::lexical_cast<int>(params.at(2)))) {
+                    CASPAR_THROW_EXCEPTION(invalid_argument());
+                }
+ 
+                result = std::to_wstring(producer_->playlist().size());
+            } else if (value.empty() || boost::iequals(value, L"list")) {
+                // One entry per line, the one playing is marked with a *
+                const auto          playlist = producer_->playlist();
+                const auto          index    = producer_->playlist_index();
+                std::wostringstream str;
+                for (std::size_t n = 0; n < playlist.size(); ++n) {
+                    str << n << (static_cast<int>(n) == index ? L"* " : L" ") << u16(playlist[n]) << L"\n";
+                }
+ 
+                result = str.str();
+            } else {
+                CASPAR_THROW_EXCEPTION(invalid_argument());
+            }
         } else {
             CASPAR_THROW_EXCEPTION(invalid_argument());
         }
@@ -190,7 +250,7 @@ static bool is_valid_gstreamer_file(const boost::filesystem::path& path)
         L".wma", L".nut", L".flac", L".opus", L".ogg", L".webm"
     };
     static const std::set<std::wstring> valid_protocols = {
-        L"rtmp://", L"rtmps://", L"http://", L"https://", L"mms://", L"rtp://", L"udp://"
+        L"rtmp://", L"rtmps://", L"http://", L"https://", L"mms://", L"rtp://", L"udp://", L"srt://"
     };
     
     auto ext = boost::to_lower_copy(path.extension().wstring());
@@ -211,6 +271,22 @@ static bool is_valid_gstreamer_file(const boost::filesystem::path& path)
     return false;
 }
  
+// Local clips are looked up in the media folder, streams are checked against the known protocols
+static std::optional<std::wstring> resolve_path(const std::wstring& name)
+{
+    if (!boost::contains(name, L"://")) {
+        auto fullMediaPath = find_file_within_dir_or_absolute(env::media_folder(), name, is_valid_gstreamer_file);
+        if (fullMediaPath) {
+            return fullMediaPath->wstring();
+        }
+        return {};
+    }
+    if (!is_valid_gstreamer_file(name)) {
+        return {};
+    }
+    return name;
+}
+ 
 spl::shared_ptr<core::frame_producer> create_producer(const core::frame_producer_dependencies& dependencies,
                                                       const std::vector<std::wstring>&         params)
 {
@@ -230,23 +306,37 @@ spl::shared_ptr<core::frame_producer> create_producer(const core::frame_producer
         name = params_copy.at(0);
     }
     
-    auto path = name;
- 
-    if (!boost::contains(path, L"://")) {
-        auto fullMediaPath = find_file_within_dir_or_absolute(env::media_folder(), path, is_valid_gstreamer_file);
-        if (fullMediaPath) {
-            path = fullMediaPath->wstring();
-        } else {
+    // PLAYLIST a.mp4 b.mp4 ... plays the clips back to back in one pipeline. The first parameter
+    // that isn't a clip starts the regular parameters.
+    std::vector<std::wstring> playlist;
+    if (boost::iequals(name, L"PLAYLIST")) {
+        for (std::size_t n = 1; n < params_copy.size(); ++n) {
+            auto entry = resolve_path(params_copy.at(n));
+            if (!entry) {
+                break;
+            }
+            playlist.push_back(*entry);
+        }
+        if (playlist.empty()) {
             return core::frame_producer::empty();
         }
-    } else if (!is_valid_gstreamer_file(path)) {
-        return core::frame_producer::empty();
+        name = params_copy.at(1);
     }
  
+    auto path = playlist.empty() ? resolve_path(name).value_or(L"") : playlist.front();
+ 
     if (path.empty()) {
         return core::frame_producer::empty();
     }
  
+    // SRT settings given as parameters override those in the URI
+    if (srt::is_srt(u8(path))) {
+        path = u16(srt::with_options(u8(path),
+                                     {{"mode", u8(boost::to_lower_copy(get_param(L"SRT_MODE", params_copy, std::wstring())))},
+                                      {"latency", u8(get_param(L"SRT_LATENCY", params_copy, std::wstring()))},
+                                      {"passphrase", u8(get_param(L"SRT_PASSPHRASE", params_copy, std::wstring()))}}));
+    }
+ 
     auto loop = contains_param(L"LOOP", params_copy);
  
     auto seek = get_param(L"SEEK", params_copy, static_cast<uint32_t>(0));
@@ -283,19 +373,48 @@ spl::shared_ptr<core::frame_producer> create_producer(const core::frame_producer
         duration = out - in;
     }
  
+    // Clip ranges don't carry over from one playlist entry to the next
+    if (!playlist.empty()) {
+        start.reset();
+        duration.reset();
+    }
+ 
     auto vfilter = get_param(L"VF", params_copy, filter_str);
  
+    // Target latency in frames for live sources
+    std::optional<int> live;
+    if (contains_param(L"LIVE", params_copy)) {
+        live = get_param(L"LATENCY", params_copy, config().live_latency);
+    }
+ 
+    // Mix neighbouring frames when the source rate differs from the channel
+    auto blend = contains_param(L"BLEND", params_copy);
+ 
+    // videoscale method used to size the video for the channel
+    auto scaler = boost::to_lower_copy(get_param(L"SCALER", params_copy, u16(config().scaler)));
+ 
+    // Thread priority and affinity, unknown names fail the command
+    std::optional<thread_policy> policy;
+    if (contains_param(L"POLICY", params_copy)) {
+        policy = thread_policies::find(u8(get_param(L"POLICY", params_copy, std::wstring())));
+    }
+ 
     try {
         return spl::make_shared<gstreamer_producer>(dependencies.frame_factory,
                                                   dependencies.format_desc,
-                                                  name,
                                                   path,
+                                                  name,
                                                   vfilter,
                                                   start,
                                                   seek2,
                                                   duration,
                                                   loop,
-                                                  scale_mode);
+                                                  scale_mode,
+                                                  playlist,
+                                                  live,
+                                                  blend,
+                                                  scaler,
+                                                  policy);
     } catch (...) {
         CASPAR_LOG_CURRENT_EXCEPTION();
     }
@@ -0,0 +1,98 @@
+#include "gst_bus_dispatcher.h"
+
+#include <common/log.h>
+#include <common/os/thread.h>
+
+#include <mutex>
+#include <thread>
+
+namespace caspar { namespace gstreamer { namespace bus_dispatcher {
+
+namespace {
+
+struct bus_watch
+{
+    std::recursive_mutex mutex; // Held while the handler runs, recursive for handlers that release
+    handler              on_message;
+    bool                 active = true;
+};
+
+class dispatcher
+{
+  public:
+    dispatcher()
+        : context_(g_main_context_new())
+        , loop_(g_main_loop_new(context_, FALSE))
+    {
+        std::thread([this] {
+            set_thread_name(L"[gstreamer::bus]");
+            g_main_context_push_thread_default(context_);
+            g_main_loop_run(loop_);
+            g_main_context_pop_thread_default(context_);
+        }).detach();
+    }
+
+    GSource* attach(GstBus* bus, std::shared_ptr<bus_watch> watch)
+    {
+        GSource* source = gst_bus_create_watch(bus);
+        g_source_set_callback(source,
+                              reinterpret_cast<GSourceFunc>(&dispatcher::dispatch),
+                              new std::shared_ptr<bus_watch>(std::move(watch)),
+                              [](gpointer data) { delete static_cast<std::shared_ptr<bus_watch>*>(data); });
+        g_source_attach(source, context_);
+        return source;
+    }
+
+  private:
+    static gboolean dispatch(GstBus* bus, GstMessage* message, gpointer user_data)
+    {
+        auto& watch = *static_cast<std::shared_ptr<bus_watch>*>(user_data);
+
+        std::lock_guard<std::recursive_mutex> lock(watch->mutex);
+        if (watch->active) {
+            try {
+                watch->on_message(message);
+            } catch (...) {
+                CASPAR_LOG_CURRENT_EXCEPTION();
+            }
+        }
+        return G_SOURCE_CONTINUE;
+    }
+
+    GMainContext* context_;
+    GMainLoop*    loop_;
+};
+
+// Runs for the lifetime of the process
+dispatcher& instance()
+{
+    static auto instance = new dispatcher();
+    return *instance;
+}
+
+} // namespace
+
+std::shared_ptr<void> watch(GstElement* pipeline, handler on_message)
+{
+    if (!pipeline) {
+        return nullptr;
+    }
+
+    auto watch        = std::make_shared<bus_watch>();
+    watch->on_message = std::move(on_message);
+
+    GstBus*   bus    = gst_element_get_bus(pipeline);
+    GSource*  source = instance().attach(bus, watch);
+    gst_object_unref(bus);
+
+    return std::shared_ptr<void>(nullptr, [watch, source](void*) {
+        {
+            std::lock_guard<std::recursive_mutex> lock(watch->mutex);
+            watch->active = false;
+        }
+        g_source_destroy(source);
+        g_source_unref(source);
+    });
+}
+
+}}} // namespace caspar::gstreamer::bus_dispatcher
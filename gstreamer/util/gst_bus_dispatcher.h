@@ -0,0 +1,26 @@
+#pragma once
+
+#include <gst/gst.h>
+
+#include <functional>
+#include <memory>
+
+namespace caspar { namespace gstreamer {
+
+// One thread serves the buses of all pipelines. It runs a GMainLoop on a private context with a
+// bus watch per pipeline, so messages are handed over as soon as they are posted, and the thread
+// sleeps while no bus has anything to say.
+//
+// Handlers run on the dispatcher thread and should not block, everything else waits for them.
+namespace bus_dispatcher {
+
+using handler = std::function<void(GstMessage* message)>;
+
+// Delivers the messages of the pipeline's bus to the handler until the returned watch is
+// released. Releasing it waits for a handler that is running, so the owner can go away after.
+// Returns nullptr for a null pipeline.
+std::shared_ptr<void> watch(GstElement* pipeline, handler on_message);
+
+} // namespace bus_dispatcher
+
+}} // namespace caspar::gstreamer
@@ -0,0 +1,89 @@
+#include "gst_config.h"
+
+#include <common/env.h>
+#include <common/log.h>
+#include <common/utf.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+namespace caspar { namespace gstreamer {
+
+namespace {
+
+gst_config g_config;
+
+} // namespace
+
+const gst_config& config() { return g_config; }
+
+void load_config()
+{
+    gst_config cfg;
+    cfg.probe_cache_path = (boost::filesystem::path(env::data_folder()) / L"gstreamer-cache").string();
+
+    try {
+        if (auto gstreamer = env::properties().get_child_optional(L"configuration.gstreamer")) {
+            cfg.debug_level         = gstreamer->get(L"debug-level", cfg.debug_level);
+            cfg.probe_cache         = gstreamer->get(L"probe-cache", cfg.probe_cache);
+            cfg.probe_cache_path    = u8(gstreamer->get(L"probe-cache-path", u16(cfg.probe_cache_path)));
+            cfg.preroll_pool_size   = gstreamer->get(L"preroll-pool-size", cfg.preroll_pool_size);
+            cfg.preroll_pool_memory = gstreamer->get(L"preroll-pool-memory", cfg.preroll_pool_memory);
+            cfg.buffer_min          = gstreamer->get(L"buffer-min", cfg.buffer_min);
+            cfg.buffer_max          = gstreamer->get(L"buffer-max", cfg.buffer_max);
+            cfg.live_latency        = gstreamer->get(L"live-latency", cfg.live_latency);
+            cfg.open_timeout        = gstreamer->get(L"open-timeout", cfg.open_timeout);
+            cfg.stall_timeout       = gstreamer->get(L"stall-timeout", cfg.stall_timeout);
+            cfg.reconnect_delay     = gstreamer->get(L"reconnect-delay", cfg.reconnect_delay);
+            cfg.reconnect_max_delay = gstreamer->get(L"reconnect-max-delay", cfg.reconnect_max_delay);
+            cfg.trickmode_threshold = gstreamer->get(L"trickmode-threshold", cfg.trickmode_threshold);
+            cfg.reverse_cache       = gstreamer->get(L"reverse-cache", cfg.reverse_cache);
+            cfg.scaler              = u8(gstreamer->get(L"scaler", u16(cfg.scaler)));
+            cfg.threads             = gstreamer->get(L"threads", cfg.threads);
+            cfg.task_pool_size      = gstreamer->get(L"task-pool-size", cfg.task_pool_size);
+            cfg.teardown_threads    = gstreamer->get(L"teardown-threads", cfg.teardown_threads);
+            cfg.teardown_queue      = gstreamer->get(L"teardown-queue", cfg.teardown_queue);
+
+            if (auto policies = gstreamer->get_child_optional(L"thread-policies")) {
+                for (const auto& item : *policies) {
+                    if (item.first != L"policy") {
+                        continue;
+                    }
+                    thread_policy policy;
+                    policy.name      = u8(item.second.get(L"name", L""));
+                    policy.priority  = u8(item.second.get(L"priority", u16(policy.priority)));
+                    policy.cpus      = u8(item.second.get(L"cpus", L""));
+                    policy.numa_node = item.second.get(L"numa-node", policy.numa_node);
+
+                    std::wstringstream channels(item.second.get(L"channels", L""));
+                    for (std::wstring channel; std::getline(channels, channel, L',');) {
+                        policy.channels.push_back(std::stoi(channel));
+                    }
+                    cfg.thread_policies.push_back(std::move(policy));
+                }
+            }
+        }
+    } catch (...) {
+        // Keep the defaults for anything that can't be parsed
+        CASPAR_LOG_CURRENT_EXCEPTION();
+    }
+
+    cfg.buffer_min = std::max(cfg.buffer_min, 1);
+    cfg.buffer_max = std::max(cfg.buffer_max, cfg.buffer_min);
+
+    if (const char* debug_level = std::getenv("CASPARCG_GST_DEBUG_LEVEL")) {
+        try {
+            cfg.debug_level = std::stoi(debug_level);
+        } catch (...) {
+            // Ignore conversion errors and use the configured level
+        }
+    }
+
+    g_config = cfg;
+}
+
+}} // namespace caspar::gstreamer
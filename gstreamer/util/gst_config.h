@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace caspar { namespace gstreamer {
+
+// Scheduling of the threads of a producer or consumer and its pipeline, see gst_thread_policy.h
+struct thread_policy
+{
+    std::string      name;
+    std::vector<int> channels;            // Consumers of these channels use it unless they name another
+    std::string      priority  = "normal"; // low, normal, high or realtime
+    std::string      cpus;                // CPU list such as "0-3,8", empty for any
+    int              numa_node = -1;      // Also restricts to the CPUs of the node
+};
+
+// Module settings from the <gstreamer> element of casparcg.config. Loaded once by init() and
+// read-only afterwards.
+struct gst_config
+{
+    int debug_level = 2;
+
+    // Media probe cache, see gst_probe_cache.h
+    bool        probe_cache      = true;
+    std::string probe_cache_path;
+
+    // Prerolled inputs kept for reuse, see gst_preroll_pool.h
+    int preroll_pool_size   = 4;
+    int preroll_pool_memory = 1024; // MB
+
+    // Limits of the adaptive producer buffer, in frames
+    int buffer_min = 2;
+    int buffer_max = 32;
+
+    // Default target latency of LIVE producers, in frames
+    int live_latency = 3;
+
+    // Producers that decode nothing within this many ms fail, 0 waits forever
+    int open_timeout = 10000;
+
+    // Network inputs are reconnected after errors and after stall-timeout ms without data, 0 only
+    // on errors. Attempts back off from reconnect-delay to reconnect-max-delay ms.
+    int stall_timeout       = 2000;
+    int reconnect_delay     = 250;
+    int reconnect_max_delay = 2000;
+
+    // Rates above this only decode keyframes
+    double trickmode_threshold = 2.0;
+
+    // Decoded frames cached for reverse playback, MB
+    int reverse_cache = 512;
+
+    // Default videoscale method of producers, empty for the videoscale default
+    std::string scaler;
+
+    // Cores shared by the elements of all pipelines, 0 for all of them
+    int threads = 0;
+
+    // Idle streaming threads kept for reuse, see gst_task_pool.h
+    int task_pool_size = 16;
+
+    // Workers and queue limit of the pipeline teardown, see gst_teardown.h
+    int teardown_threads = 2;
+    int teardown_queue   = 16;
+
+    // Named thread policies
+    std::vector<thread_policy> thread_policies;
+};
+
+const gst_config& config();
+
+// Reads the configuration, the CASPARCG_GST_DEBUG_LEVEL environment variable overrides debug-level
+void load_config();
+
+}} // namespace caspar::gstreamer
@@ -0,0 +1,164 @@
+#include "gst_probe_cache.h"
+#include "gst_config.h"
+
+#include <common/log.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+namespace caspar { namespace gstreamer { namespace probe_cache {
+
+namespace {
+
+struct entry
+{
+    file_stamp key;
+    media_info info;
+};
+
+// Bumped when what an entry means changes, older entries are probed again
+const int format_version = 2;
+
+std::mutex                   g_mutex;
+std::map<std::string, entry> g_entries;
+
+boost::filesystem::path cache_file(const std::string& path)
+{
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << std::hash<std::string>{}(path) << ".json";
+    return boost::filesystem::path(config().probe_cache_path) / name.str();
+}
+
+std::optional<media_info> load(const std::string& path, const file_stamp& key)
+{
+    const auto file = cache_file(path);
+
+    boost::system::error_code ec;
+    if (!boost::filesystem::exists(file, ec)) {
+        return {};
+    }
+
+    boost::property_tree::ptree tree;
+    boost::property_tree::read_json(file.string(), tree);
+
+    // A different file hashing to the same name, or the file changed since it was probed
+    if (tree.get("version", 0) != format_version || tree.get("path", std::string()) != path || tree.get("mtime", int64_t{0}) != key.mtime ||
+        tree.get("size", uint64_t{0}) != key.size) {
+        return {};
+    }
+
+    media_info info;
+    info.duration      = tree.get("duration", int64_t{0});
+    info.video_caps    = tree.get("video-caps", std::string());
+    info.audio_caps    = tree.get("audio-caps", std::string());
+    info.video_decoder = tree.get("video-decoder", std::string());
+    info.indexed_until = tree.get("indexed-until", int64_t{-1});
+
+    std::istringstream keyframes(tree.get("keyframes", std::string()));
+    for (int64_t pts; keyframes >> pts;) {
+        info.keyframes.push_back(pts);
+    }
+
+    return info;
+}
+
+void save(const std::string& path, const file_stamp& key, const media_info& info)
+{
+    boost::property_tree::ptree tree;
+    tree.put("version", format_version);
+    tree.put("path", path);
+    tree.put("mtime", key.mtime);
+    tree.put("size", key.size);
+    tree.put("duration", info.duration);
+    tree.put("video-caps", info.video_caps);
+    tree.put("audio-caps", info.audio_caps);
+    tree.put("video-decoder", info.video_decoder);
+    tree.put("indexed-until", info.indexed_until);
+
+    std::ostringstream keyframes;
+    for (auto pts : info.keyframes) {
+        keyframes << pts << ' ';
+    }
+    tree.put("keyframes", keyframes.str());
+
+    const auto file = cache_file(path);
+    boost::filesystem::create_directories(file.parent_path());
+
+    // Written aside and renamed so a concurrent load never sees half a file
+    auto tmp = file;
+    tmp += ".tmp";
+    boost::property_tree::write_json(tmp.string(), tree, std::locale(), false);
+    boost::filesystem::rename(tmp, file);
+}
+
+} // namespace
+
+std::optional<file_stamp> stamp(const std::string& path)
+{
+    boost::system::error_code ec;
+    if (!boost::filesystem::is_regular_file(path, ec) || ec) {
+        return {};
+    }
+
+    file_stamp result;
+    result.mtime = static_cast<int64_t>(boost::filesystem::last_write_time(path, ec));
+    result.size  = static_cast<uint64_t>(boost::filesystem::file_size(path, ec));
+    if (ec) {
+        return {};
+    }
+    return result;
+}
+
+std::optional<media_info> find(const std::string& path, const file_stamp& stamp)
+{
+    if (!config().probe_cache) {
+        return {};
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        auto                        it = g_entries.find(path);
+        if (it != g_entries.end() && it->second.key == stamp) {
+            return it->second.info;
+        }
+    }
+
+    try {
+        auto info = load(path, stamp);
+        if (info) {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_entries[path] = entry{stamp, *info};
+        }
+        return info;
+    } catch (...) {
+        CASPAR_LOG(warning) << "[gstreamer] Ignoring unreadable probe cache entry for " << path;
+        return {};
+    }
+}
+
+void store(const std::string& path, const file_stamp& stamp, const media_info& info)
+{
+    if (!config().probe_cache) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_entries[path] = entry{stamp, info};
+    }
+
+    try {
+        save(path, stamp, info);
+    } catch (...) {
+        CASPAR_LOG(warning) << "[gstreamer] Failed to write probe cache entry for " << path;
+    }
+}
+
+}}} // namespace caspar::gstreamer::probe_cache
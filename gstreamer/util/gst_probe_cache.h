@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace caspar { namespace gstreamer {
+
+// What a previous load learned about a local media file
+struct media_info
+{
+    int64_t              duration = 0; // Milliseconds
+    std::string          video_caps;   // Caps negotiated at the video appsink
+    std::string          audio_caps;
+    std::string          video_decoder;
+    std::vector<int64_t> keyframes;          // Stream time in nanoseconds, sorted
+    int64_t              indexed_until = -1; // Decoded without a gap from the start up to here
+};
+
+// Identifies one version of a local file
+struct file_stamp
+{
+    int64_t  mtime = 0;
+    uint64_t size  = 0;
+
+    bool operator==(const file_stamp& other) const { return mtime == other.mtime && size == other.size; }
+};
+
+// Media metadata cache keyed by path, modification time and size. Entries are kept in memory
+// and persisted as one JSON file per clip in the configured cache directory, so duration, caps
+// and the keyframe index are known before the first buffer of a repeat load.
+//
+// Network URIs and files that can't be stat'ed are never cached.
+namespace probe_cache {
+
+// The file as it is now, nothing for network URIs and files that can't be stat'ed. Taken when a
+// load starts and passed to find() and store(), so what is learned from one version of a file
+// is never stored for another one that replaced it in the meantime.
+std::optional<file_stamp> stamp(const std::string& path);
+
+std::optional<media_info> find(const std::string& path, const file_stamp& stamp);
+void                      store(const std::string& path, const file_stamp& stamp, const media_info& info);
+
+} // namespace probe_cache
+
+}} // namespace caspar::gstreamer
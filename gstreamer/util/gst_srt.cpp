@@ -0,0 +1,195 @@
+#include "gst_srt.h"
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace caspar { namespace gstreamer { namespace srt {
+
+namespace {
+
+using query = std::vector<std::pair<std::string, std::string>>;
+
+query parse_query(const std::string& uri, std::string& base)
+{
+    query result;
+
+    const auto pos = uri.find('?');
+    base           = uri.substr(0, pos);
+    if (pos == std::string::npos) {
+        return result;
+    }
+
+    std::size_t begin = pos + 1;
+    while (begin <= uri.size()) {
+        auto end = uri.find('&', begin);
+        if (end == std::string::npos) {
+            end = uri.size();
+        }
+        const auto item = uri.substr(begin, end - begin);
+        if (!item.empty()) {
+            const auto eq = item.find('=');
+            result.emplace_back(item.substr(0, eq), eq != std::string::npos ? item.substr(eq + 1) : std::string());
+        }
+        begin = end + 1;
+    }
+    return result;
+}
+
+std::string to_uri(const std::string& base, const query& items)
+{
+    std::string result = base;
+    for (const auto& item : items) {
+        result += (&item == &items.front() ? "?" : "&") + item.first + "=" + item.second;
+    }
+    return result;
+}
+
+std::string escape(const std::string& value)
+{
+    gchar*      escaped = g_uri_escape_string(value.c_str(), nullptr, FALSE);
+    std::string result  = escaped;
+    g_free(escaped);
+    return result;
+}
+
+// Counters are int, int64 or uint64 depending on the field and the GStreamer version
+double number(const GstStructure* structure, const char* field)
+{
+    const GValue* value = gst_structure_get_value(structure, field);
+    if (!value) {
+        return 0.0;
+    }
+
+    GValue result = G_VALUE_INIT;
+    g_value_init(&result, G_TYPE_DOUBLE);
+    const auto number = g_value_transform(value, &result) ? g_value_get_double(&result) : 0.0;
+    g_value_unset(&result);
+    return number;
+}
+
+int64_t count(const GstStructure* structure, const char* field)
+{
+    return static_cast<int64_t>(number(structure, field));
+}
+
+// Senders and receivers report different fields, whichever is missing counts as zero
+void accumulate(const GstStructure* structure, stats& result)
+{
+    result.callers++;
+    result.rtt_ms = std::max(result.rtt_ms, number(structure, "rtt-ms"));
+    result.rate_mbps += number(structure, "send-rate-mbps") + number(structure, "receive-rate-mbps");
+    result.latency_ms = std::max(result.latency_ms, count(structure, "negotiated-latency-ms"));
+    result.packets += count(structure, "packets-sent") + count(structure, "packets-received");
+    result.retransmitted += count(structure, "packets-retransmitted") + count(structure, "packet-nack-sent");
+    result.lost += count(structure, "packets-sent-lost") + count(structure, "packets-received-lost");
+    result.dropped += count(structure, "packets-sent-dropped") + count(structure, "packets-received-dropped");
+}
+
+void accumulate(const GValue* value, stats& result)
+{
+    if (GST_VALUE_HOLDS_STRUCTURE(value)) {
+        accumulate(gst_value_get_structure(value), result);
+    }
+}
+
+} // namespace
+
+bool is_srt(const std::string& uri) { return boost::algorithm::istarts_with(uri, "srt://"); }
+
+std::string with_options(const std::string& uri, const std::map<std::string, std::string>& options)
+{
+    std::string base;
+    auto        items = parse_query(uri, base);
+
+    for (const auto& option : options) {
+        if (option.second.empty()) {
+            continue;
+        }
+        const auto value = escape(option.second);
+        auto       it    = std::find_if(items.begin(), items.end(), [&](const auto& item) { return item.first == option.first; });
+        if (it != items.end()) {
+            it->second = value;
+        } else {
+            items.emplace_back(option.first, value);
+        }
+    }
+    return to_uri(base, items);
+}
+
+std::string option(const std::string& uri, const std::string& name)
+{
+    std::string base;
+    for (const auto& item : parse_query(uri, base)) {
+        if (item.first == name) {
+            return item.second;
+        }
+    }
+    return {};
+}
+
+std::string redact(const std::string& text)
+{
+    static const std::string key = "passphrase=";
+
+    auto result = text;
+    for (auto pos = result.find(key); pos != std::string::npos; pos = result.find(key, pos)) {
+        pos += key.size();
+        const auto end = result.find_first_of("&\" ", pos);
+        result.replace(pos, (end != std::string::npos ? end : result.size()) - pos, "***");
+    }
+    return result;
+}
+
+std::optional<stats> read(GstElement* element)
+{
+    if (!element || !g_object_class_find_property(G_OBJECT_GET_CLASS(element), "stats")) {
+        return {};
+    }
+
+    GstStructure* structure = nullptr;
+    g_object_get(G_OBJECT(element), "stats", &structure, NULL);
+    if (!structure) {
+        return {};
+    }
+
+    stats result;
+
+    // A listener reports each of its callers, a caller itself
+    if (const GValue* callers = gst_structure_get_value(structure, "callers")) {
+        if (GST_VALUE_HOLDS_ARRAY(callers)) {
+            for (guint n = 0; n < gst_value_array_get_size(callers); ++n) {
+                accumulate(gst_value_array_get_value(callers, n), result);
+            }
+        } else if (G_VALUE_HOLDS(callers, G_TYPE_VALUE_ARRAY)) {
+            const auto array = static_cast<GValueArray*>(g_value_get_boxed(callers));
+            for (guint n = 0; array && n < array->n_values; ++n) {
+                accumulate(&array->values[n], result);
+            }
+        }
+    } else if (gst_structure_n_fields(structure) > 0) {
+        accumulate(structure, result);
+    }
+    gst_structure_free(structure);
+
+    if (result.callers == 0) {
+        return {};
+    }
+    return result;
+}
+
+void publish(const stats& stats, core::monitor::state& state)
+{
+    state["srt/callers"]       = stats.callers;
+    state["srt/rtt"]           = stats.rtt_ms;
+    state["srt/rate"]          = stats.rate_mbps;
+    state["srt/latency"]       = stats.latency_ms;
+    state["srt/packets"]       = stats.packets;
+    state["srt/retransmitted"] = stats.retransmitted;
+    state["srt/lost"]          = stats.lost;
+    state["srt/dropped"]       = stats.dropped;
+}
+
+}}} // namespace caspar::gstreamer::srt
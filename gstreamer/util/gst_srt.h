@@ -0,0 +1,54 @@
+#pragma once
+
+#include <core/monitor/monitor.h>
+
+#include <gst/gst.h>
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+
+namespace caspar { namespace gstreamer {
+
+// SRT contribution links, played through srtsrc and sent through srtsink. Both take their
+// settings from the query of the srt:// URI, e.g. srt://:7001?mode=listener&latency=200, which
+// is where the LATENCY, MODE and PASSPHRASE parameters end up as well.
+namespace srt {
+
+bool is_srt(const std::string& uri);
+
+// The URI with the options set in its query, replacing those already there. Empty values are
+// left out.
+std::string with_options(const std::string& uri, const std::map<std::string, std::string>& options);
+
+// Value of an option in the query of the URI, empty when it isn't set
+std::string option(const std::string& uri, const std::string& name);
+
+// The text, a URI or a pipeline description, with SRT passphrases masked for logs and state
+std::string redact(const std::string& text);
+
+// Transport statistics of one srtsrc or srtsink. A listener sums the counters of its callers and
+// reports the worst round trip. Retransmits are those sent by a sender and those requested by a
+// receiver, dropped packets arrived too late to be played out.
+struct stats
+{
+    int     callers        = 0;
+    double  rtt_ms         = 0.0;
+    double  rate_mbps      = 0.0; // Sent and received
+    int64_t latency_ms     = 0;   // Negotiated
+    int64_t packets        = 0;   // Sent or received
+    int64_t retransmitted  = 0;
+    int64_t lost           = 0;
+    int64_t dropped        = 0;
+};
+
+// Statistics of the element, nothing while it isn't connected
+std::optional<stats> read(GstElement* element);
+
+// Reports the statistics as srt/* in the state
+void publish(const stats& stats, core::monitor::state& state);
+
+} // namespace srt
+
+}} // namespace caspar::gstreamer
@@ -0,0 +1,325 @@
+#include "gst_task_pool.h"
+
+#include "gst_config.h"
+#include "gst_thread_policy.h"
+#include "gst_util.h"
+
+#include <common/log.h>
+#include <common/os/thread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace caspar { namespace gstreamer { namespace task_pool {
+
+namespace {
+
+// Set on a worker that couldn't go back to normal scheduling after a task, it exits instead of
+// running tasks of other pipelines with the policy of the last one
+thread_local bool t_retire = false;
+
+std::atomic<bool> g_reset_warned{false};
+
+void retire(const char* when)
+{
+    t_retire = true;
+    if (!g_reset_warned.exchange(true)) {
+        CASPAR_LOG(warning) << "[gstreamer] Streaming thread can't go back to normal priority " << when
+                            << ", retiring it. Lowering priority needs CAP_SYS_NICE to undo.";
+    } else {
+        CASPAR_LOG(debug) << "[gstreamer] Retiring streaming thread " << when;
+    }
+}
+
+// Runs jobs on worker threads and keeps up to 'size' of them idle between jobs. A job never
+// waits for another one to finish, there is always a worker free or a new one.
+class worker_pool
+{
+  public:
+    void push(std::function<void()> job)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Idle workers that aren't about to take a queued job yet
+        const bool idle = idle_ > static_cast<int>(jobs_.size());
+        jobs_.push_back(std::move(job));
+        if (idle) {
+            cond_.notify_one();
+            return;
+        }
+
+        busy_++;
+        std::thread([this] { run(); }).detach();
+    }
+
+    int busy() const { return busy_; }
+    int idle() const { return idle_; }
+
+  private:
+    void run()
+    {
+        set_thread_name(L"[gstreamer::streaming]");
+
+        // New threads inherit the scheduling of whichever thread started the task
+        if (!thread_policies::reset()) {
+            retire("when started");
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            while (!jobs_.empty()) {
+                auto job = std::move(jobs_.front());
+                jobs_.pop_front();
+
+                lock.unlock();
+                try {
+                    job();
+                } catch (...) {
+                    CASPAR_LOG_CURRENT_EXCEPTION();
+                }
+                lock.lock();
+
+                if (t_retire) {
+                    break;
+                }
+            }
+
+            if (t_retire || idle_ >= std::max(config().task_pool_size, 0)) {
+                break;
+            }
+
+            busy_--;
+            idle_++;
+            cond_.wait(lock, [this] { return !jobs_.empty(); });
+            idle_--;
+            busy_++;
+        }
+        busy_--;
+    }
+
+    std::mutex                        mutex_;
+    std::condition_variable           cond_;
+    std::deque<std::function<void()>> jobs_;
+    std::atomic<int>                  busy_{0};
+    std::atomic<int>                  idle_{0};
+};
+
+// Outlives the streaming threads it owns, which are detached
+worker_pool& workers()
+{
+    static auto pool = new worker_pool();
+    return *pool;
+}
+
+std::atomic<int> g_pipelines{0};
+
+} // namespace
+
+}}} // namespace caspar::gstreamer::task_pool
+
+// GstTaskPool that hands streaming tasks to the shared workers
+struct CasparTaskPool
+{
+    GstTaskPool parent;
+};
+
+struct CasparTaskPoolClass
+{
+    GstTaskPoolClass parent_class;
+};
+
+G_DEFINE_TYPE(CasparTaskPool, caspar_task_pool, GST_TYPE_TASK_POOL)
+
+static void caspar_task_pool_prepare(GstTaskPool* pool, GError** error) {}
+
+static void caspar_task_pool_cleanup(GstTaskPool* pool) {}
+
+static gpointer caspar_task_pool_push(GstTaskPool* pool, GstTaskPoolFunction func, gpointer user_data, GError** error)
+{
+    caspar::gstreamer::task_pool::workers().push([func, user_data] { func(user_data); });
+    return nullptr;
+}
+
+// GstTask waits for its function to return before it joins, nothing is left to wait for here
+static void caspar_task_pool_join(GstTaskPool* pool, gpointer id) {}
+
+static void caspar_task_pool_class_init(CasparTaskPoolClass* klass)
+{
+    GstTaskPoolClass* pool_class = GST_TASK_POOL_CLASS(klass);
+    pool_class->prepare          = caspar_task_pool_prepare;
+    pool_class->cleanup          = caspar_task_pool_cleanup;
+    pool_class->push             = caspar_task_pool_push;
+    pool_class->join             = caspar_task_pool_join;
+}
+
+static void caspar_task_pool_init(CasparTaskPool* pool) {}
+
+namespace caspar { namespace gstreamer { namespace task_pool {
+
+namespace {
+
+GstTaskPool* pool()
+{
+    static GstTaskPool* pool = GST_TASK_POOL(g_object_new(caspar_task_pool_get_type(), nullptr));
+    return pool;
+}
+
+std::atomic<bool> g_policy_warned{false};
+
+// Elements with a thread count. Their share changes with the number of pipelines, so they are
+// held weakly and set again whenever a pipeline comes or goes.
+std::mutex                             g_threaded_mutex;
+std::vector<std::unique_ptr<GWeakRef>> g_threaded;
+
+GQuark threaded_quark()
+{
+    static const GQuark quark = g_quark_from_static_string("caspar-thread-budget");
+    return quark;
+}
+
+bool set_threads(GstElement* element, const std::string& threads)
+{
+    const bool n_threads   = try_set_property(element, "n-threads", threads);
+    const bool max_threads = try_set_property(element, "max-threads", threads);
+    return n_threads || max_threads;
+}
+
+void rebalance()
+{
+    std::vector<GstElement*> elements;
+    {
+        std::lock_guard<std::mutex> lock(g_threaded_mutex);
+        for (auto it = g_threaded.begin(); it != g_threaded.end();) {
+            if (auto element = g_weak_ref_get(it->get())) {
+                elements.push_back(GST_ELEMENT(element));
+                ++it;
+            } else {
+                g_weak_ref_clear(it->get());
+                it = g_threaded.erase(it);
+            }
+        }
+    }
+
+    const auto threads = std::to_string(element_threads());
+    for (auto element : elements) {
+        set_threads(element, threads);
+        gst_object_unref(element);
+    }
+}
+
+GstBusSyncReply sync_handler(GstBus* bus, GstMessage* message, gpointer user_data)
+{
+    if (GST_MESSAGE_TYPE(message) != GST_MESSAGE_STREAM_STATUS) {
+        return GST_BUS_PASS;
+    }
+
+    GstStreamStatusType type;
+    GstElement*         owner = nullptr;
+    gst_message_parse_stream_status(message, &type, &owner);
+
+    // The task isn't running yet when its creation is posted
+    const GValue* value = gst_message_get_stream_status_object(message);
+    if (type == GST_STREAM_STATUS_TYPE_CREATE && value && G_VALUE_HOLDS(value, GST_TYPE_TASK)) {
+        gst_task_set_pool(GST_TASK(g_value_get_object(value)), pool());
+        return GST_BUS_PASS;
+    }
+
+    // Enter and leave are posted from the streaming thread itself, which is shared between
+    // pipelines and goes back to normal scheduling when the task leaves
+    const auto policy = thread_policies::get(static_cast<GstElement*>(user_data));
+    if (!policy) {
+        return GST_BUS_PASS;
+    }
+    if (type == GST_STREAM_STATUS_TYPE_ENTER) {
+        if (!thread_policies::apply(*policy) && !g_policy_warned.exchange(true)) {
+            CASPAR_LOG(warning) << "[gstreamer] Thread policy " << policy->name
+                                << " can't be applied to streaming threads";
+        }
+    } else if (type == GST_STREAM_STATUS_TYPE_LEAVE && !thread_policies::reset()) {
+        retire("after a task");
+    }
+    return GST_BUS_PASS;
+}
+
+void element_added(GstBin* bin, GstBin* sub_bin, GstElement* element, gpointer user_data)
+{
+    apply_budget(element);
+}
+
+void pipeline_finalized(gpointer user_data, GObject* pipeline)
+{
+    g_pipelines--;
+    rebalance();
+}
+
+} // namespace
+
+void install(GstElement* pipeline)
+{
+    g_pipelines++;
+    g_object_weak_ref(G_OBJECT(pipeline), &pipeline_finalized, nullptr);
+    rebalance();
+
+    GstBus* bus = gst_element_get_bus(pipeline);
+    gst_bus_set_sync_handler(bus, &sync_handler, pipeline, nullptr);
+    gst_object_unref(bus);
+
+    if (!GST_IS_BIN(pipeline)) {
+        return;
+    }
+
+    g_signal_connect(pipeline, "deep-element-added", G_CALLBACK(&element_added), nullptr);
+
+    GstIterator* it = gst_bin_iterate_recurse(GST_BIN(pipeline));
+    gst_iterator_foreach(
+        it, [](const GValue* item, gpointer) { apply_budget(GST_ELEMENT(g_value_get_object(item))); }, nullptr);
+    gst_iterator_free(it);
+}
+
+void apply_budget(GstElement* element)
+{
+    if (!set_threads(element, std::to_string(element_threads()))) {
+        return;
+    }
+
+    // Elements are set up once per pipeline they are added to, they are tracked only once
+    if (g_object_get_qdata(G_OBJECT(element), threaded_quark())) {
+        return;
+    }
+    g_object_set_qdata(G_OBJECT(element), threaded_quark(), GINT_TO_POINTER(1));
+
+    auto ref = std::make_unique<GWeakRef>();
+    g_weak_ref_init(ref.get(), element);
+
+    std::lock_guard<std::mutex> lock(g_threaded_mutex);
+    g_threaded.push_back(std::move(ref));
+}
+
+int element_threads() { return std::max(budget() / std::max(g_pipelines.load(), 1), 1); }
+
+int budget()
+{
+    static const int threads =
+        config().threads > 0 ? config().threads : static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+    return threads;
+}
+
+int busy_threads() { return workers().busy(); }
+
+int idle_threads() { return workers().idle(); }
+
+tbb::task_arena& arena()
+{
+    static tbb::task_arena arena(budget());
+    return arena;
+}
+
+}}} // namespace caspar::gstreamer::task_pool
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <gst/gst.h>
+
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+namespace caspar { namespace gstreamer {
+
+// Threads shared by all pipelines of the module.
+//
+// Streaming tasks of every pipeline run on one GstTaskPool. Streaming tasks loop until their
+// pad stops, so the pool never queues them: a task gets an idle worker or a new thread, and up
+// to task-pool-size workers stay around for the next pipeline instead of exiting.
+//
+// Elements that parallelise their work (n-threads, max-threads) and the frame copies share a
+// budget of threads cores, split evenly between the pipelines. The elements are set again
+// whenever a pipeline is installed or released.
+namespace task_pool {
+
+// Runs the streaming tasks of the pipeline on the shared pool and sets the thread count of its
+// elements, including those added later, from the budget. Streaming threads follow the thread
+// policy set on the pipeline, see gst_thread_policy.h.
+void install(GstElement* pipeline);
+
+// Sets n-threads or max-threads of the element from the budget when it has them, and keeps
+// them at the share as pipelines come and go
+void apply_budget(GstElement* element);
+
+// Share of the thread budget for one element
+int element_threads();
+
+// Size of the thread budget
+int budget();
+
+// Streaming threads running a task and idle in the pool
+int busy_threads();
+int idle_threads();
+
+// Arena for frame copies, limited to the thread budget
+tbb::task_arena& arena();
+
+template <typename Func>
+void parallel_for(int first, int last, const Func& func)
+{
+    arena().execute([&] { tbb::parallel_for(first, last, func); });
+}
+
+} // namespace task_pool
+
+}} // namespace caspar::gstreamer
@@ -0,0 +1,102 @@
+#include "gst_teardown.h"
+
+#include "gst_config.h"
+
+#include <common/log.h>
+#include <common/os/thread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace caspar { namespace gstreamer { namespace teardown {
+
+namespace {
+
+thread_local bool t_worker = false;
+
+class service
+{
+  public:
+    service()
+    {
+        const auto threads = std::max(config().teardown_threads, 1);
+        for (int n = 0; n < threads; ++n) {
+            std::thread([this] { run(); }).detach();
+        }
+    }
+
+    void post(std::function<void()> job)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        const auto limit = static_cast<std::size_t>(std::max(config().teardown_queue, 1));
+        if (jobs_.size() >= limit) {
+            CASPAR_LOG(warning) << "[gstreamer] Teardown is falling behind, " << jobs_.size() << " pipelines waiting";
+            room_.wait(lock, [&] { return jobs_.size() < limit; });
+        }
+
+        jobs_.push_back(std::move(job));
+        pending_++;
+        ready_.notify_one();
+    }
+
+    int pending() const { return pending_; }
+
+  private:
+    void run()
+    {
+        set_thread_name(L"[gstreamer::teardown]");
+        t_worker = true;
+
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [&] { return !jobs_.empty(); });
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+            room_.notify_all();
+
+            try {
+                job();
+            } catch (...) {
+                CASPAR_LOG_CURRENT_EXCEPTION();
+            }
+            job = nullptr;
+            pending_--;
+        }
+    }
+
+    std::mutex                        mutex_;
+    std::condition_variable           ready_;
+    std::condition_variable           room_;
+    std::deque<std::function<void()>> jobs_;
+    std::atomic<int>                  pending_{0};
+};
+
+// Runs for the lifetime of the process
+service& instance()
+{
+    static auto instance = new service();
+    return *instance;
+}
+
+} // namespace
+
+void post(std::function<void()> job)
+{
+    if (t_worker) {
+        job();
+        return;
+    }
+    instance().post(std::move(job));
+}
+
+int pending() { return instance().pending(); }
+
+}}} // namespace caspar::gstreamer::teardown
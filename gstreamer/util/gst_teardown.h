@@ -0,0 +1,23 @@
+#pragma once
+
+#include <functional>
+
+namespace caspar { namespace gstreamer {
+
+// Pipelines are torn down on a few teardown-threads workers instead of the thread that lets go
+// of them. Stopping a pipeline waits for its streaming threads and releasing the last frames
+// can take a while, neither belongs on a channel thread.
+//
+// At most teardown-queue jobs wait. Beyond that post() blocks until a worker catches up, so rapid
+// CLEAR/PLAY cycles slow down instead of piling up pipelines. Jobs posted from a teardown worker
+// run right away.
+namespace teardown {
+
+void post(std::function<void()> job);
+
+// Jobs queued or running
+int pending();
+
+} // namespace teardown
+
+}} // namespace caspar::gstreamer
@@ -0,0 +1,245 @@
+#include "gst_thread_policy.h"
+
+#include <common/except.h>
+#include <common/log.h>
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace caspar { namespace gstreamer { namespace thread_policies {
+
+namespace {
+
+const char* const policy_key = "caspar-thread-policy";
+
+// "0-3,8" to {0, 1, 2, 3, 8}
+std::set<int> parse_cpus(const std::string& list)
+{
+    std::set<int> cpus;
+
+    std::vector<std::string> ranges;
+    boost::split(ranges, list, boost::is_any_of(","));
+    for (auto range : ranges) {
+        boost::trim(range);
+        if (range.empty()) {
+            continue;
+        }
+        const auto dash  = range.find('-');
+        const auto first = std::stoi(range.substr(0, dash));
+        const auto last  = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.insert(cpu);
+        }
+    }
+    return cpus;
+}
+
+// CPUs of the policy, empty for any
+std::set<int> policy_cpus(const thread_policy& policy)
+{
+    auto cpus = parse_cpus(policy.cpus);
+    if (policy.numa_node < 0) {
+        return cpus;
+    }
+
+    std::set<int> node;
+#ifdef _WIN32
+    GROUP_AFFINITY affinity = {};
+    if (GetNumaNodeProcessorMaskEx(static_cast<USHORT>(policy.numa_node), &affinity) && affinity.Group == 0) {
+        for (int cpu = 0; cpu < 64; ++cpu) {
+            if (affinity.Mask & (KAFFINITY(1) << cpu)) {
+                node.insert(cpu);
+            }
+        }
+    }
+#else
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(policy.numa_node) + "/cpulist");
+    std::string   list;
+    if (std::getline(file, list)) {
+        node = parse_cpus(list);
+    }
+#endif
+    if (node.empty()) {
+        CASPAR_LOG(warning) << "[gstreamer] Unknown NUMA node " << policy.numa_node << " in thread policy "
+                            << policy.name;
+        return cpus;
+    }
+    if (cpus.empty()) {
+        return node;
+    }
+
+    std::set<int> both;
+    std::set_intersection(cpus.begin(), cpus.end(), node.begin(), node.end(), std::inserter(both, both.end()));
+    return both;
+}
+
+#ifdef _WIN32
+
+bool set_priority(const std::string& priority)
+{
+    int value = THREAD_PRIORITY_NORMAL;
+    if (priority == "realtime") {
+        value = THREAD_PRIORITY_TIME_CRITICAL;
+    } else if (priority == "high") {
+        value = THREAD_PRIORITY_ABOVE_NORMAL;
+    } else if (priority == "low") {
+        value = THREAD_PRIORITY_BELOW_NORMAL;
+    }
+    return SetThreadPriority(GetCurrentThread(), value) != 0;
+}
+
+bool set_cpus(const std::set<int>& cpus)
+{
+    DWORD_PTR process = 0;
+    DWORD_PTR system  = 0;
+    GetProcessAffinityMask(GetCurrentProcess(), &process, &system);
+
+    DWORD_PTR mask = cpus.empty() ? process : 0;
+    for (auto cpu : cpus) {
+        if (cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+            mask |= DWORD_PTR(1) << cpu;
+        }
+    }
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+}
+
+#else
+
+bool set_priority(const std::string& priority)
+{
+    const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+
+    if (priority == "realtime") {
+        sched_param param{};
+        param.sched_priority = sched_get_priority_min(SCHED_RR) + 10;
+        return pthread_setschedparam(pthread_self(), SCHED_RR, &param) == 0;
+    }
+
+    // Leaves realtime scheduling, then the nice value sets the weight among normal threads
+    sched_param param{};
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+
+    const int nice = priority == "high" ? -10 : priority == "low" ? 10 : 0;
+    return setpriority(PRIO_PROCESS, tid, nice) == 0;
+}
+
+// The affinity of the main thread, which no policy touches. Threads without a CPU list go back
+// to it.
+const cpu_set_t& process_cpus()
+{
+    static const cpu_set_t cpus = [] {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(getpid(), sizeof(set), &set) != 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        return set;
+    }();
+    return cpus;
+}
+
+bool set_cpus(const std::set<int>& cpus)
+{
+    cpu_set_t set = process_cpus();
+    if (!cpus.empty()) {
+        CPU_ZERO(&set);
+        for (auto cpu : cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+#endif
+
+} // namespace
+
+thread_policy find(const std::string& name)
+{
+    for (const auto& policy : config().thread_policies) {
+        if (boost::iequals(policy.name, name)) {
+            return policy;
+        }
+    }
+    CASPAR_THROW_EXCEPTION(user_error() << msg_info_t("Unknown thread policy: " + name));
+}
+
+std::optional<thread_policy> for_channel(int channel)
+{
+    for (const auto& policy : config().thread_policies) {
+        if (std::find(policy.channels.begin(), policy.channels.end(), channel) != policy.channels.end()) {
+            return policy;
+        }
+    }
+    return {};
+}
+
+bool apply(const thread_policy& policy)
+{
+    bool applied = true;
+    try {
+        applied = set_priority(policy.priority) && applied;
+        applied = set_cpus(policy_cpus(policy)) && applied;
+    } catch (...) {
+        CASPAR_LOG_CURRENT_EXCEPTION();
+        applied = false;
+    }
+    return applied;
+}
+
+bool reset()
+{
+    const bool priority = set_priority("normal");
+    const bool cpus     = set_cpus({});
+    return priority && cpus;
+}
+
+void set(GstElement* pipeline, const thread_policy& policy)
+{
+    g_object_set_data_full(G_OBJECT(pipeline), policy_key, new thread_policy(policy), [](gpointer data) {
+        delete static_cast<thread_policy*>(data);
+    });
+}
+
+const thread_policy* get(GstElement* pipeline)
+{
+    return static_cast<const thread_policy*>(g_object_get_data(G_OBJECT(pipeline), policy_key));
+}
+
+std::string describe(const thread_policy& policy)
+{
+    std::ostringstream str;
+    str << policy.name << " " << policy.priority;
+    if (!policy.cpus.empty()) {
+        str << " cpus " << policy.cpus;
+    }
+    if (policy.numa_node >= 0) {
+        str << " node " << policy.numa_node;
+    }
+    return str.str();
+}
+
+}}} // namespace caspar::gstreamer::thread_policies
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "gst_config.h"
+
+#include <gst/gst.h>
+
+#include <optional>
+#include <string>
+
+namespace caspar { namespace gstreamer {
+
+// Thread policies set the priority and CPU affinity of the threads working for one producer or
+// consumer: its own thread and the streaming threads of its pipeline. On-air channels can run
+// at realtime priority on their own cores so preview and recording decodes don't starve them.
+//
+// Realtime priority needs CAP_SYS_NICE on Linux. When the OS refuses a setting the thread
+// keeps running as it was and the policy is reported as not applied.
+namespace thread_policies {
+
+// The configured policy with that name, throws user_error when there is none
+thread_policy find(const std::string& name);
+
+// The policy configured for the channel, if any
+std::optional<thread_policy> for_channel(int channel);
+
+// Applies the policy to the calling thread, false when the OS refused part of it
+bool apply(const thread_policy& policy);
+
+// Puts the calling thread back to normal priority on all CPUs of the process, false when the OS
+// refused. Raising a lowered nice value back to normal needs CAP_SYS_NICE on Linux as well.
+bool reset();
+
+// Streaming threads of the pipeline apply the policy while they run one of its tasks
+void set(GstElement* pipeline, const thread_policy& policy);
+
+// The policy of the pipeline, nullptr for none
+const thread_policy* get(GstElement* pipeline);
+
+// Short description for diagnostics, e.g. "pgm realtime cpus 0-3"
+std::string describe(const thread_policy& policy);
+
+} // namespace thread_policies
+
+}} // namespace caspar::gstreamer
@@ -1,9 +1,13 @@
 #include "gst_util.h"
 #include "gst_assert.h"
+#include "gst_task_pool.h"
 
-#include <tbb/parallel_for.h>
 #include <tbb/parallel_invoke.h>
 
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
 // Disable specific warnings for this file
 #ifdef _MSC_VER
 #pragma warning(push)
@@ -101,6 +105,25 @@ core::pixel_format_desc gst_format_to_caspar(GstVideoInfo* video_info)
             format = core::pixel_format::ycbcr;
             depth = common::bit_depth::bit12;
             break;
+        case GST_VIDEO_FORMAT_Y42B:
+        case GST_VIDEO_FORMAT_Y444:
+        case GST_VIDEO_FORMAT_NV12:
+        case GST_VIDEO_FORMAT_NV21:
+            // NV12/NV21 chroma is de-interleaved into separate planes by make_frame
+            format = core::pixel_format::ycbcr;
+            depth = common::bit_depth::bit8;
+            break;
+        case GST_VIDEO_FORMAT_I422_10LE:
+        case GST_VIDEO_FORMAT_v210:
+            // v210 is unpacked into 10-bit planes by make_frame
+            format = core::pixel_format::ycbcr;
+            depth = common::bit_depth::bit10;
+            break;
+        case GST_VIDEO_FORMAT_P010_10LE:
+            // P010 keeps its samples in the high bits, so it is read as full 16-bit range
+            format = core::pixel_format::ycbcr;
+            depth = common::bit_depth::bit16;
+            break;
         case GST_VIDEO_FORMAT_A420:
             format = core::pixel_format::ycbcra;
             depth = common::bit_depth::bit8;
@@ -162,22 +185,14 @@ core::pixel_format_desc gst_format_to_caspar(GstVideoInfo* video_info)
             desc.planes.push_back(core::pixel_format_desc::plane(width, height, 4, depth));
             break;
         case core::pixel_format::ycbcr:
-            // Y plane
-            desc.planes.push_back(core::pixel_format_desc::plane(width, height, 1, depth));
-            // U plane (half resolution in both dimensions for 4:2:0)
-            desc.planes.push_back(core::pixel_format_desc::plane(width/2, height/2, 1, depth));
-            // V plane (half resolution in both dimensions for 4:2:0)
-            desc.planes.push_back(core::pixel_format_desc::plane(width/2, height/2, 1, depth));
-            break;
         case core::pixel_format::ycbcra:
-            // Y plane
-            desc.planes.push_back(core::pixel_format_desc::plane(width, height, 1, depth));
-            // U plane (half resolution in both dimensions for 4:2:0)
-            desc.planes.push_back(core::pixel_format_desc::plane(width/2, height/2, 1, depth));
-            // V plane (half resolution in both dimensions for 4:2:0)
-            desc.planes.push_back(core::pixel_format_desc::plane(width/2, height/2, 1, depth));
-            // Alpha plane
-            desc.planes.push_back(core::pixel_format_desc::plane(width, height, 1, depth));
+            // One plane per component (Y, U, V and optionally A) sized by the format's subsampling
+            for (int c = 0; c < (format == core::pixel_format::ycbcra ? 4 : 3); ++c) {
+                desc.planes.push_back(core::pixel_format_desc::plane(GST_VIDEO_INFO_COMP_WIDTH(video_info, c),
+                                                                     GST_VIDEO_INFO_COMP_HEIGHT(video_info, c),
+                                                                     1,
+                                                                     depth));
+            }
             break;
         case core::pixel_format::uyvy:
             desc.planes.push_back(core::pixel_format_desc::plane(width/2, height, 4, depth));
@@ -189,6 +204,88 @@ core::pixel_format_desc gst_format_to_caspar(GstVideoInfo* video_info)
     return desc;
 }
 
+namespace {
+
+// Keeps the buffer of a sample mapped for as long as a frame plane refers to it.
+struct mapped_sample
+{
+    GstSample* sample;
+    GstBuffer* buffer;
+    GstMapInfo map;
+
+    explicit mapped_sample(GstSample* s)
+        : sample(gst_sample_ref(s))
+        , buffer(gst_sample_get_buffer(s))
+    {
+        if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+            gst_sample_unref(sample);
+            CASPAR_THROW_EXCEPTION(gstreamer_error_t() << gstreamer_error_info("Failed to map buffer")
+                                                       << boost::errinfo_api_function("gst_buffer_map"));
+        }
+    }
+
+    ~mapped_sample()
+    {
+        gst_buffer_unmap(buffer, &map);
+        gst_sample_unref(sample);
+    }
+
+    mapped_sample(const mapped_sample&)            = delete;
+    mapped_sample& operator=(const mapped_sample&) = delete;
+};
+
+// Planes that are wrapped instead of copied must start on this boundary so the
+// mixer upload can use aligned copies.
+const std::uintptr_t plane_alignment = 32;
+
+// Splits an interleaved chroma plane (NV12, NV21, P010) into two planar chroma planes.
+template <typename T>
+void deinterleave_chroma(const std::uint8_t* src, int src_stride, std::uint8_t* first, std::uint8_t* second, int width, int height)
+{
+    task_pool::parallel_for(0, height, [&](int y) {
+        auto s = reinterpret_cast<const T*>(src + y * src_stride);
+        auto a = reinterpret_cast<T*>(first) + y * width;
+        auto b = reinterpret_cast<T*>(second) + y * width;
+        for (int x = 0; x < width; ++x) {
+            a[x] = s[2 * x];
+            b[x] = s[2 * x + 1];
+        }
+    });
+}
+
+// Unpacks v210 (six 10-bit 4:2:2 pixels in four little-endian words) into 16-bit Y, Cb and Cr planes.
+void unpack_v210(const std::uint8_t* src, int src_stride, std::uint8_t* y_plane, std::uint8_t* cb_plane, std::uint8_t* cr_plane, int width, int chroma_width, int height)
+{
+    task_pool::parallel_for(0, height, [&](int row) {
+        auto s  = reinterpret_cast<const std::uint32_t*>(src + row * src_stride);
+        auto yp = reinterpret_cast<std::uint16_t*>(y_plane) + row * width;
+        auto cb = reinterpret_cast<std::uint16_t*>(cb_plane) + row * chroma_width;
+        auto cr = reinterpret_cast<std::uint16_t*>(cr_plane) + row * chroma_width;
+
+        for (int x = 0; x < width; x += 6, s += 4) {
+            const std::uint16_t samples[12] = {
+                static_cast<std::uint16_t>(s[0] & 0x3ff), static_cast<std::uint16_t>((s[0] >> 10) & 0x3ff),
+                static_cast<std::uint16_t>((s[0] >> 20) & 0x3ff), static_cast<std::uint16_t>(s[1] & 0x3ff),
+                static_cast<std::uint16_t>((s[1] >> 10) & 0x3ff), static_cast<std::uint16_t>((s[1] >> 20) & 0x3ff),
+                static_cast<std::uint16_t>(s[2] & 0x3ff), static_cast<std::uint16_t>((s[2] >> 10) & 0x3ff),
+                static_cast<std::uint16_t>((s[2] >> 20) & 0x3ff), static_cast<std::uint16_t>(s[3] & 0x3ff),
+                static_cast<std::uint16_t>((s[3] >> 10) & 0x3ff), static_cast<std::uint16_t>((s[3] >> 20) & 0x3ff),
+            };
+
+            // Sample order is Cb0 Y0 Cr0 Y1 Cb1 Y2 Cr1 Y3 Cb2 Y4 Cr2 Y5
+            for (int n = 0; n < 6 && x + n < width; ++n) {
+                yp[x + n] = samples[2 * n + 1];
+            }
+            for (int n = 0; n < 3 && x / 2 + n < chroma_width; ++n) {
+                cb[x / 2 + n] = samples[4 * n];
+                cr[x / 2 + n] = samples[4 * n + 2];
+            }
+        }
+    });
+}
+
+} // namespace
+
 core::mutable_frame make_frame(void* tag,
                               core::frame_factory& frame_factory,
                               GstSample* sample,
@@ -205,79 +302,114 @@ core::mutable_frame make_frame(void* tag,
     GST_CHECK(gst_video_info_from_caps(&video_info, caps), "Failed to extract video info from caps");
     
     auto format_desc = gst_format_to_caspar((&video_info));
+    if (format_desc.format == core::pixel_format::invalid) {
+        return frame_factory.create_frame(tag, format_desc);
+    }
+    
+    const auto gst_format  = GST_VIDEO_INFO_FORMAT(&video_info);
+    const bool semi_planar = gst_format == GST_VIDEO_FORMAT_NV12 || gst_format == GST_VIDEO_FORMAT_NV21 ||
+                             gst_format == GST_VIDEO_FORMAT_P010_10LE;
+    const bool v210        = gst_format == GST_VIDEO_FORMAT_v210;
+    
+    auto mapped = std::make_shared<mapped_sample>(sample);
+    
+    // Upstream elements that pad their planes describe the real layout with GstVideoMeta,
+    // otherwise the default layout from the caps applies.
+    const GstVideoMeta* meta = gst_buffer_get_video_meta(buffer);
+    
+    const auto plane_count = format_desc.planes.size();
+    std::vector<const std::uint8_t*> sources(plane_count);
+    std::vector<int>                 strides(plane_count);
+    std::vector<bool>                direct(plane_count);
+    bool                             wrap = true;
+    
+    for (std::size_t p = 0; p < plane_count; ++p) {
+        // CasparCG planes are per component, GStreamer may pack several components into one plane
+        const auto& plane     = format_desc.planes[p];
+        const int   gst_plane = v210 ? 0 : GST_VIDEO_INFO_COMP_PLANE(&video_info, static_cast<int>(p));
+        const gsize offset    = meta ? meta->offset[gst_plane] : GST_VIDEO_INFO_PLANE_OFFSET(&video_info, gst_plane);
+        const int   stride    = meta ? meta->stride[gst_plane] : GST_VIDEO_INFO_PLANE_STRIDE(&video_info, gst_plane);
+        
+        direct[p] = !v210 && !(semi_planar && p > 0);
+        
+        const gsize row_size = direct[p] ? plane.linesize : static_cast<gsize>(std::abs(stride));
+        GST_CHECK(stride >= static_cast<int>(row_size) &&
+                      offset + static_cast<gsize>(stride) * (plane.height - 1) + row_size <= mapped->map.size,
+                  "Buffer is too small for its video info");
+        
+        sources[p] = mapped->map.data + offset;
+        strides[p] = stride;
+        
+        // The mixer expects tightly packed planes, so padded or misaligned ones have to be copied.
+        wrap = wrap && direct[p] && stride == plane.linesize &&
+               reinterpret_cast<std::uintptr_t>(sources[p]) % plane_alignment == 0;
+    }
+    
+    if (wrap) {
+        // Zero-copy: every plane points into the mapped buffer and keeps the sample alive
+        // until the mixer releases the frame.
+        std::vector<array<std::uint8_t>> image_data;
+        for (std::size_t p = 0; p < plane_count; ++p) {
+            image_data.emplace_back(
+                const_cast<std::uint8_t*>(sources[p]), static_cast<std::size_t>(format_desc.planes[p].size), mapped);
+        }
+        return core::mutable_frame(tag, std::move(image_data), array<std::int32_t>{}, format_desc);
+    }
+    
     auto frame = frame_factory.create_frame(tag, format_desc);
     
-    GstMapInfo map;
-    GST_CHECK(gst_buffer_map(buffer, &map, GST_MAP_READ), "Failed to map buffer");
+    if (v210) {
+        unpack_v210(sources[0],
+                    strides[0],
+                    frame.image_data(0).begin(),
+                    frame.image_data(1).begin(),
+                    frame.image_data(2).begin(),
+                    format_desc.planes[0].width,
+                    format_desc.planes[1].width,
+                    format_desc.planes[0].height);
+        return frame;
+    }
     
-    // Copy video data from GStreamer buffer to CasparCG frame
-    switch (format_desc.format) {
-        case core::pixel_format::bgra:
-        case core::pixel_format::rgba:
-        case core::pixel_format::argb:
-        case core::pixel_format::abgr:
-        case core::pixel_format::rgb:
-        case core::pixel_format::bgr: {
-            // For packed formats with a single plane
-            auto plane = format_desc.planes[0];
-            int line_size = GST_VIDEO_INFO_PLANE_STRIDE(&video_info, 0);
-            
-            int plane_height = static_cast<int>(plane.height);
-            
-            tbb::parallel_for(0, plane_height, [&](int y) {
-                std::memcpy(
-                    frame.image_data(0).begin() + y * plane.linesize,
-                    map.data + y * line_size,
-                    plane.linesize);
-            });
-            break;
+    if (semi_planar) {
+        // NV21 stores V before U
+        const bool swap   = gst_format == GST_VIDEO_FORMAT_NV21;
+        auto       first  = frame.image_data(swap ? 2 : 1).begin();
+        auto       second = frame.image_data(swap ? 1 : 2).begin();
+        const auto& plane = format_desc.planes[1];
+        
+        if (format_desc.planes[1].depth == common::bit_depth::bit8) {
+            deinterleave_chroma<std::uint8_t>(sources[1], strides[1], first, second, plane.width, plane.height);
+        } else {
+            deinterleave_chroma<std::uint16_t>(sources[1], strides[1], first, second, plane.width, plane.height);
         }
-        case core::pixel_format::ycbcr: {
-            // For planar YUV formats
-            for (int p = 0; p < 3; ++p) {
-                auto plane = format_desc.planes[p];
-                int offset = GST_VIDEO_INFO_PLANE_OFFSET(&video_info, p);
-                int stride = GST_VIDEO_INFO_PLANE_STRIDE(&video_info, p);
-                
-                int plane_height = static_cast<int>(plane.height);
-                
-                tbb::parallel_for(0, plane_height, [&](int y) {
-                    std::memcpy(
-                        frame.image_data(p).begin() + y * plane.linesize,
-                        map.data + offset + y * stride,
-                        plane.linesize);
-                });
-            }
-            break;
+    }
+    
+    for (std::size_t p = 0; p < plane_count; ++p) {
+        if (!direct[p]) {
+            continue;
         }
-        case core::pixel_format::ycbcra: {
-            // For planar YUV formats with alpha
-            for (int p = 0; p < 4; ++p) {
-                auto plane = format_desc.planes[p];
-                int offset = GST_VIDEO_INFO_PLANE_OFFSET(&video_info, p);
-                int stride = GST_VIDEO_INFO_PLANE_STRIDE(&video_info, p);
-                
-                int plane_height = static_cast<int>(plane.height);
-                
-                tbb::parallel_for(0, plane_height, [&](int y) {
-                    std::memcpy(
-                        frame.image_data(p).begin() + y * plane.linesize,
-                        map.data + offset + y * stride,
-                        plane.linesize);
-                });
-            }
-            break;
+        
+        const auto& plane = format_desc.planes[p];
+        
+        // Luma of semi-planar formats can still be wrapped when only the chroma needs unpacking
+        if (strides[p] == plane.linesize && reinterpret_cast<std::uintptr_t>(sources[p]) % plane_alignment == 0) {
+            frame.image_data(static_cast<int>(p)) =
+                array<std::uint8_t>(const_cast<std::uint8_t*>(sources[p]), static_cast<std::size_t>(plane.size), mapped);
+            continue;
         }
-        default:
-            // Handle other formats
-            break;
+        
+        auto dest = frame.image_data(static_cast<int>(p)).begin();
+        
+        if (strides[p] == plane.linesize) {
+            std::memcpy(dest, sources[p], plane.size);
+            continue;
+        }
+        
+        task_pool::parallel_for(0, plane.height, [&](int y) {
+            std::memcpy(dest + y * plane.linesize, sources[p] + y * strides[p], plane.linesize);
+        });
     }
     
-    gst_buffer_unmap(buffer, &map);
-    
-    // Handle audio if available
-    // For now, we leave audio handling to be implemented later
-    
     return frame;
 }
 
@@ -326,7 +458,7 @@ GstSample* make_gst_sample(const core::const_frame& frame, const core::video_for
             
             int plane_height = static_cast<int>(plane.height);
             
-            tbb::parallel_for(0, plane_height, [&](int y) {
+            task_pool::parallel_for(0, plane_height, [&](int y) {
                 std::memcpy(
                     map.data + y * line_size,
                     frame.image_data(0).begin() + y * plane.linesize,
@@ -343,7 +475,7 @@ GstSample* make_gst_sample(const core::const_frame& frame, const core::video_for
                 
                 int plane_height = static_cast<int>(plane.height);
                 
-                tbb::parallel_for(0, plane_height, [&](int y) {
+                task_pool::parallel_for(0, plane_height, [&](int y) {
                     std::memcpy(
                         map.data + offset + y * stride,
                         frame.image_data(p).begin() + y * plane.linesize,
@@ -361,7 +493,7 @@ GstSample* make_gst_sample(const core::const_frame& frame, const core::video_for
                 
                 int plane_height = static_cast<int>(plane.height);
                 
-                tbb::parallel_for(0, plane_height, [&](int y) {
+                task_pool::parallel_for(0, plane_height, [&](int y) {
                     std::memcpy(
                         map.data + offset + y * stride,
                         frame.image_data(p).begin() + y * plane.linesize,
@@ -408,9 +540,57 @@ gst_ptr<GstElement> create_pipeline(const std::string& pipeline_description)
                               << boost::errinfo_api_function("gst_parse_launch"));
     }
     
+    task_pool::install(pipeline);
+    
     return make_gst_ptr<GstElement>(pipeline);
 }
 
+gst_ptr<GstElement> make_element(const std::string& factory, const std::string& name)
+{
+    GstElement* element = gst_element_factory_make(factory.c_str(), name.empty() ? nullptr : name.c_str());
+    
+    if (!element) {
+        CASPAR_THROW_EXCEPTION(gstreamer_error_t()
+                              << gstreamer_error_info("Missing GStreamer element: " + factory)
+                              << boost::errinfo_api_function("gst_element_factory_make"));
+    }
+    
+    return make_gst_ptr<GstElement>(GST_ELEMENT(gst_object_ref_sink(element)));
+}
+
+bool try_set_property(GstElement* element, const std::string& name, const std::string& value)
+{
+    if (!g_object_class_find_property(G_OBJECT_GET_CLASS(element), name.c_str())) {
+        return false;
+    }
+    gst_util_set_object_arg(G_OBJECT(element), name.c_str(), value.c_str());
+    return true;
+}
+
+GstElement* make_sink_bin(const std::string& name, const std::vector<GstElement*>& elements)
+{
+    GstElement* bin = gst_bin_new(name.c_str());
+    
+    for (auto element : elements) {
+        gst_bin_add(GST_BIN(bin), element);
+    }
+    
+    for (std::size_t n = 1; n < elements.size(); ++n) {
+        if (!gst_element_link(elements[n - 1], elements[n])) {
+            gst_object_unref(gst_object_ref_sink(bin));
+            CASPAR_THROW_EXCEPTION(gstreamer_error_t()
+                                  << gstreamer_error_info("Failed to link elements of " + name)
+                                  << boost::errinfo_api_function("gst_element_link"));
+        }
+    }
+    
+    GstPad* pad = gst_element_get_static_pad(elements.front(), "sink");
+    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad));
+    gst_object_unref(pad);
+    
+    return bin;
+}
+
 std::map<std::string, std::string> parse_gst_structure(GstStructure* structure)
 {
     std::map<std::string, std::string> result;
@@ -446,6 +626,47 @@ std::map<std::string, std::string> parse_gst_structure(GstStructure* structure)
     return result;
 }
 
+int64_t sample_running_time(GstSample* sample)
+{
+    GstBuffer*        buffer  = gst_sample_get_buffer(sample);
+    const GstSegment* segment = gst_sample_get_segment(sample);
+    if (!buffer || !GST_BUFFER_PTS_IS_VALID(buffer)) {
+        return -1;
+    }
+    if (!segment || segment->format != GST_FORMAT_TIME) {
+        return static_cast<int64_t>(GST_BUFFER_PTS(buffer));
+    }
+
+    const auto running_time = gst_segment_to_running_time(segment, GST_FORMAT_TIME, GST_BUFFER_PTS(buffer));
+    return GST_CLOCK_TIME_IS_VALID(running_time) ? static_cast<int64_t>(running_time) : -1;
+}
+
+field_order buffer_field_order(const GstVideoInfo& info, GstBuffer* buffer)
+{
+    switch (GST_VIDEO_INFO_INTERLACE_MODE(&info)) {
+        case GST_VIDEO_INTERLACE_MODE_INTERLEAVED:
+            break;
+        case GST_VIDEO_INTERLACE_MODE_MIXED:
+            if (!buffer || !GST_BUFFER_FLAG_IS_SET(buffer, GST_VIDEO_BUFFER_FLAG_INTERLACED)) {
+                return field_order::progressive;
+            }
+            break;
+        default:
+            return field_order::progressive;
+    }
+
+    // The caps only carry the field order when it is fixed for the whole stream
+    switch (GST_VIDEO_INFO_FIELD_ORDER(&info)) {
+        case GST_VIDEO_FIELD_ORDER_TOP_FIELD_FIRST:
+            return field_order::top_first;
+        case GST_VIDEO_FIELD_ORDER_BOTTOM_FIELD_FIRST:
+            return field_order::bottom_first;
+        default:
+            return buffer && GST_BUFFER_FLAG_IS_SET(buffer, GST_VIDEO_BUFFER_FLAG_TFF) ? field_order::top_first
+                                                                                       : field_order::bottom_first;
+    }
+}
+
 std::string caps_to_string(GstCaps* caps)
 {
     if (!caps)
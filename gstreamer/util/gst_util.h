@@ -90,6 +90,10 @@ GstVideoFormat pixel_format_to_gst(core::pixel_format format, common::bit_depth
 core::pixel_format_desc gst_format_to_caspar(GstVideoInfo* video_info);
 
 // Frame conversion utilities
+//
+// make_frame wraps the mapped sample memory without copying when the planes are tightly
+// packed and aligned; the frame then holds a reference to the sample. Otherwise the
+// planes are copied into a frame from the frame factory.
 core::mutable_frame make_frame(void* tag,
                               core::frame_factory& frame_factory,
                               GstSample* sample,
@@ -97,8 +101,31 @@ core::mutable_frame make_frame(void* tag,
 
 GstSample* make_gst_sample(const core::const_frame& frame, const core::video_format_desc& format_desc);
 
+// Running time of the sample's buffer in nanoseconds, -1 when untimed or outside its segment.
+// Unlike the buffer timestamps it keeps increasing across non-flushing segment seeks.
+int64_t sample_running_time(GstSample* sample);
+
+enum class field_order
+{
+    progressive,
+    top_first,
+    bottom_first,
+};
+
+// Field order of a decoded frame, from the caps and for mixed content the buffer flags
+field_order buffer_field_order(const GstVideoInfo& info, GstBuffer* buffer);
+
 // Pipeline creation utilities
 gst_ptr<GstElement> create_pipeline(const std::string& pipeline_description);
+gst_ptr<GstElement> make_element(const std::string& factory, const std::string& name = "");
+
+// Sets a property from its string form, false when the element has no such property
+bool try_set_property(GstElement* element, const std::string& name, const std::string& value);
+
+// Links the elements in order and wraps them in a bin with a "sink" ghost pad on the first one.
+// The elements and the returned bin are owned by whoever the bin is handed to.
+GstElement* make_sink_bin(const std::string& name, const std::vector<GstElement*>& elements);
+
 std::map<std::string, std::string> parse_gst_structure(GstStructure* structure);
 std::string caps_to_string(GstCaps* caps);
 
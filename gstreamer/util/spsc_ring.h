@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace caspar { namespace gstreamer {
+
+// Bounded single-producer/single-consumer ring with preallocated slots.
+//
+// try_push() may only be called from one thread and front()/try_pop() only from one other
+// thread. Neither side ever blocks or allocates; the read and write positions live on separate
+// cache lines so the two threads don't contend for them.
+template <typename T>
+class spsc_ring
+{
+  public:
+    explicit spsc_ring(std::size_t capacity)
+        : capacity_(capacity)
+        , slots_(round_up_pow2(capacity))
+        , mask_(slots_.size() - 1)
+    {
+    }
+
+    spsc_ring(const spsc_ring&)            = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    // Producer side
+    bool try_push(T&& value)
+    {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= capacity_) {
+            return false;
+        }
+
+        slots_[head & mask_].value = std::move(value);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, the returned slot stays valid until the next try_pop()
+    T* front()
+    {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        return &slots_[tail & mask_].value;
+    }
+
+    bool try_pop(T& value)
+    {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        // Leave an empty slot behind so the consumer releases what it popped
+        auto& slot = slots_[tail & mask_].value;
+        value      = std::move(slot);
+        slot       = T{};
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Either side, exact only when called from one of them
+    std::size_t size() const
+    {
+        const auto tail = tail_.load(std::memory_order_acquire);
+        return head_.load(std::memory_order_acquire) - tail;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    std::size_t capacity() const { return capacity_; }
+
+  private:
+    static constexpr std::size_t cache_line = 64;
+
+    struct alignas(cache_line) slot
+    {
+        T value;
+    };
+
+    static std::size_t round_up_pow2(std::size_t value)
+    {
+        std::size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const std::size_t capacity_;
+    std::vector<slot> slots_;
+    const std::size_t mask_;
+
+    alignas(cache_line) std::atomic<std::size_t> head_{0};
+    alignas(cache_line) std::atomic<std::size_t> tail_{0};
+};
+
+}} // namespace caspar::gstreamer